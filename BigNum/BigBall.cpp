@@ -0,0 +1,191 @@
+#include "BigBall.h"
+
+#include <algorithm>
+#include <cassert>
+
+static BigNum truncate(const BigNum& n, size_t digitsAfterDecimal)
+{
+    return BigNum::divide(n, BigNum(1), digitsAfterDecimal);
+}
+
+static BigNum unitInLastPlace(size_t precision)
+{
+    return BigNum::reciprocalPowerOf10(precision);
+}
+
+// Rounds a non-negative number up to the given number of digits after the decimal
+static BigNum roundUp(const BigNum& n, size_t digitsAfterDecimal)
+{
+    assert(!n.isNegative());
+
+    BigNum truncated = truncate(n, digitsAfterDecimal);
+
+    if (truncated != n)
+    {
+        truncated += unitInLastPlace(digitsAfterDecimal);
+    }
+
+    return truncated;
+}
+
+// Divides non-negative numbers, rounding the quotient up at the given number of digits after the decimal
+static BigNum divideRoundingUp(const BigNum& a, const BigNum& b, size_t digitsAfterDecimal)
+{
+    BigNum quotient = BigNum::divide(a, b, digitsAfterDecimal);
+
+    if ((quotient * b) != a)
+    {
+        quotient += unitInLastPlace(digitsAfterDecimal);
+    }
+
+    return quotient;
+}
+
+BigBall::BigBall(const BigNum& exact)
+    : BigBall(exact, DefaultPrecision)
+{
+}
+
+BigBall::BigBall(const BigNum& exact, size_t precision)
+    : BigBall(exact, BigNum::Zero, precision)
+{
+}
+
+BigBall::BigBall(const BigNum& midpoint, const BigNum& radius, size_t precision)
+    : midpoint(midpoint)
+    , radius(abs(radius))
+    , precision(precision)
+{
+    roundToPrecision();
+}
+
+void BigBall::roundToPrecision()
+{
+    BigNum truncated = truncate(midpoint, precision);
+
+    if (truncated != midpoint)
+    {
+        midpoint = truncated;
+        radius += unitInLastPlace(precision);
+    }
+
+    radius = roundUp(radius, precision);
+}
+
+const BigNum& BigBall::getMidpoint() const
+{
+    return midpoint;
+}
+
+const BigNum& BigBall::getRadius() const
+{
+    return radius;
+}
+
+size_t BigBall::getPrecision() const
+{
+    return precision;
+}
+
+BigBall BigBall::withPrecision(size_t precision) const
+{
+    return BigBall(midpoint, radius, precision);
+}
+
+BigNum BigBall::lowerBound() const
+{
+    return (midpoint - radius);
+}
+
+BigNum BigBall::upperBound() const
+{
+    return (midpoint + radius);
+}
+
+bool BigBall::contains(const BigNum& n) const
+{
+    return ((lowerBound() <= n) && (n <= upperBound()));
+}
+
+bool BigBall::isAccurateTo(size_t digitsAfterDecimal) const
+{
+    return (truncate(lowerBound(), digitsAfterDecimal) == truncate(upperBound(), digitsAfterDecimal));
+}
+
+std::string BigBall::display() const
+{
+    return (midpoint.display() + " +/- " + radius.display());
+}
+
+BigBall operator+(const BigBall& a, const BigBall& b)
+{
+    return BigBall(a.midpoint + b.midpoint, a.radius + b.radius, std::max(a.precision, b.precision));
+}
+
+void operator+=(BigBall& a, const BigBall& b)
+{
+    a = a + b;
+}
+
+BigBall operator-(const BigBall& ball)
+{
+    return BigBall(-(ball.midpoint), ball.radius, ball.precision);
+}
+
+BigBall operator-(const BigBall& a, const BigBall& b)
+{
+    return BigBall(a.midpoint - b.midpoint, a.radius + b.radius, std::max(a.precision, b.precision));
+}
+
+void operator-=(BigBall& a, const BigBall& b)
+{
+    a = a - b;
+}
+
+BigBall operator*(const BigBall& a, const BigBall& b)
+{
+    // |xy - ab| <= |a| rb + |b| ra + ra rb for x within ra of a and y within rb of b
+    BigNum radius = (abs(a.midpoint) * b.radius) + (abs(b.midpoint) * a.radius) + (a.radius * b.radius);
+
+    return BigBall(a.midpoint * b.midpoint, radius, std::max(a.precision, b.precision));
+}
+
+void operator*=(BigBall& a, const BigBall& b)
+{
+    a = a * b;
+}
+
+BigBall operator/(const BigBall& a, const BigBall& b)
+{
+    size_t precision = std::max(a.precision, b.precision);
+
+    BigNum denominatorLowerBound = abs(b.midpoint) - b.radius;
+
+    if (denominatorLowerBound <= BigNum::Zero)
+    {
+        // The divisor ball contains zero, so no finite radius bounds the quotient
+        assert(false);
+        return BigBall(BigNum::Zero, precision);
+    }
+
+    // |x/y - a/b| <= (|a| rb + |b| ra) / (|b| (|b| - rb)) for x within ra of a and y within rb of b
+    BigNum radiusNumerator = (abs(a.midpoint) * b.radius) + (abs(b.midpoint) * a.radius);
+    BigNum radiusDenominator = abs(b.midpoint) * denominatorLowerBound;
+
+    BigNum radius = divideRoundingUp(radiusNumerator, radiusDenominator, precision);
+
+    // The quotient is also truncated at the working precision
+    BigNum midpoint = BigNum::divide(a.midpoint, b.midpoint, precision);
+
+    if ((midpoint * b.midpoint) != a.midpoint)
+    {
+        radius += unitInLastPlace(precision);
+    }
+
+    return BigBall(midpoint, radius, precision);
+}
+
+void operator/=(BigBall& a, const BigBall& b)
+{
+    a = a / b;
+}
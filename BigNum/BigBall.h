@@ -0,0 +1,63 @@
+#pragma once
+
+#include "BigNum.h"
+
+#include <string>
+
+// A midpoint and a radius that together bound the exact value of a computation.
+// Every operation rounds its midpoint to the working precision (a number of digits
+// after the decimal) and widens the radius by whatever that rounding lost, so the
+// exact result always lies in [midpoint - radius, midpoint + radius].
+class BigBall
+{
+friend BigBall operator+(const BigBall& a, const BigBall& b);
+friend void operator+=(BigBall& a, const BigBall& b);
+friend BigBall operator-(const BigBall& ball);
+friend BigBall operator-(const BigBall& a, const BigBall& b);
+friend void operator-=(BigBall& a, const BigBall& b);
+friend BigBall operator*(const BigBall& a, const BigBall& b);
+friend void operator*=(BigBall& a, const BigBall& b);
+friend BigBall operator/(const BigBall& a, const BigBall& b);
+friend void operator/=(BigBall& a, const BigBall& b);
+
+public:
+    explicit BigBall(const BigNum& exact);
+    BigBall(const BigNum& exact, size_t precision);
+    BigBall(const BigNum& midpoint, const BigNum& radius, size_t precision);
+
+    static const size_t DefaultPrecision = 30;
+
+    const BigNum& getMidpoint() const;
+    const BigNum& getRadius() const;
+    size_t getPrecision() const; // results use the larger precision of their operands
+
+    BigBall withPrecision(size_t precision) const;
+
+    BigNum lowerBound() const;
+    BigNum upperBound() const;
+
+    bool contains(const BigNum& n) const;
+
+    // True if every number in the ball agrees on its first digitsAfterDecimal
+    // digits after the decimal, i.e. truncating it there gives a certain result
+    bool isAccurateTo(size_t digitsAfterDecimal) const;
+
+    std::string display() const; // "midpoint +/- radius"
+
+private:
+    void roundToPrecision();
+
+    BigNum midpoint;
+    BigNum radius;
+    size_t precision;
+};
+
+BigBall operator+(const BigBall& a, const BigBall& b);
+void operator+=(BigBall& a, const BigBall& b);
+BigBall operator-(const BigBall& ball);
+BigBall operator-(const BigBall& a, const BigBall& b);
+void operator-=(BigBall& a, const BigBall& b);
+BigBall operator*(const BigBall& a, const BigBall& b);
+void operator*=(BigBall& a, const BigBall& b);
+BigBall operator/(const BigBall& a, const BigBall& b);
+void operator/=(BigBall& a, const BigBall& b);
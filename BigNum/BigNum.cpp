@@ -1,12 +1,81 @@
 #include "BigNum.h"
 
 #include <algorithm>
-#include <list>
+#include <ostream>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
 #include <cassert>
 
 const BigNum BigNum::Zero("0");
+const size_t BigNum::DisplayChunkSize;
+const size_t BigNum::PowerOf10CacheSize;
 
-static std::vector<char> uintToChars(unsigned int n)
+// Number of digits processed together by the arithmetic kernels so that the
+// working set of the inner loops stays resident in cache
+static const size_t KernelBlockSize = 4096;
+
+// Below this many addends per thread, summing in parallel costs more than it saves
+static const size_t MinAddendsPerShard = 1024;
+
+// Significant digits that toDouble() looks at first, comfortably more than the 17 that
+// tell doubles apart, so that the rest of the digits rarely matter
+static const size_t ToDoubleLeadingDigits = 40;
+
+// Rows, digits or words processed between progress reports of the long running kernels
+static const size_t ProgressInterval = 1024;
+
+namespace
+{
+    thread_local BigNum::ProgressObserver* progressObserver = nullptr;
+    thread_local size_t progressDepth = 0;
+
+    // Reports the progress of one long running operation. Operations nested inside
+    // another one, e.g. the products inside pow, only give the observer a chance to stop them.
+    class ProgressScope
+    {
+    public:
+        explicit ProgressScope(size_t total)
+            : total(total)
+            , outermost(progressDepth++ == 0)
+        {
+        }
+
+        ~ProgressScope()
+        {
+            --progressDepth;
+        }
+
+        void report(size_t done)
+        {
+            if (progressObserver != nullptr)
+            {
+                progressObserver->checkpoint();
+
+                if (outermost)
+                {
+                    progressObserver->onProgress(std::min(done, total), total);
+                }
+            }
+        }
+
+    private:
+        size_t total;
+        bool outermost;
+    };
+}
+
+BigNum::ProgressObserver* BigNum::setProgressObserver(ProgressObserver* observer)
+{
+    ProgressObserver* previous = progressObserver;
+    progressObserver = observer;
+
+    return previous;
+}
+
+template <typename UnsignedInteger>
+static std::vector<char> uintToChars(UnsignedInteger n)
 {
     if (n == 0)
     {
@@ -18,7 +87,7 @@ static std::vector<char> uintToChars(unsigned int n)
     while (n != 0)
     {
         char nextChar = (n % 10);
-        n -= static_cast<unsigned int>(nextChar);
+        n -= static_cast<UnsignedInteger>(nextChar);
         n /= 10;
 
         chars.push_back(nextChar + '0');
@@ -27,31 +96,45 @@ static std::vector<char> uintToChars(unsigned int n)
     return chars;
 }
 
+// The digits with numLowZeroes zeroes below and numHighZeroes above them, built in a single allocation
+static std::vector<char> paddedDigits(size_t numLowZeroes, const std::vector<char>& digits, size_t numHighZeroes)
+{
+    std::vector<char> padded;
+    padded.reserve(numLowZeroes + digits.size() + numHighZeroes);
+
+    padded.assign(numLowZeroes, '0');
+    padded.insert(padded.end(), digits.begin(), digits.end());
+    padded.resize(padded.size() + numHighZeroes, '0');
+
+    return padded;
+}
+
 BigNum BigNum::makeWithAdditionalTrailingZeroes(const BigNum& n, size_t numAdditionalTrailingZeroes)
 {
     BigNum withAdditionalTrailingZeroes = n;
 
-    std::vector<char> zeroes(numAdditionalTrailingZeroes, '0');
-
-    std::vector<char> digits = std::move(withAdditionalTrailingZeroes.digits);
+    if (numAdditionalTrailingZeroes == 0)
+    {
+        return withAdditionalTrailingZeroes;
+    }
 
-    withAdditionalTrailingZeroes.digits = zeroes;
-    withAdditionalTrailingZeroes.digits.insert(withAdditionalTrailingZeroes.digits.end(), digits.begin(), digits.end());
+    withAdditionalTrailingZeroes.digits = paddedDigits(numAdditionalTrailingZeroes, n.digits.get(), 0);
 
     withAdditionalTrailingZeroes.decimalPosition += numAdditionalTrailingZeroes;
+    withAdditionalTrailingZeroes.normalized = false;
 
     return withAdditionalTrailingZeroes;
 }
 
-std::pair<BigNum, BigNum> makeWithLinedUpDecimalPositions(const BigNum& a, const BigNum& b)
+std::pair<BigNum, BigNum> BigNum::makeWithLinedUpDecimalPositions(const BigNum& a, const BigNum& b)
 {
-    if (a.numDigitsAfterDecimal() > b.numDigitsAfterDecimal())
+    if (a.decimalPosition > b.decimalPosition)
     {
-        return { a, BigNum::makeWithAdditionalTrailingZeroes(b, a.numDigitsAfterDecimal() - b.numDigitsAfterDecimal()) };
+        return { a, BigNum::makeWithAdditionalTrailingZeroes(b, a.decimalPosition - b.decimalPosition) };
     }
     else
     {
-        return { BigNum::makeWithAdditionalTrailingZeroes(a, b.numDigitsAfterDecimal() - a.numDigitsAfterDecimal()), b };
+        return { BigNum::makeWithAdditionalTrailingZeroes(a, b.decimalPosition - a.decimalPosition), b };
     }
 }
 
@@ -60,6 +143,12 @@ unsigned int digitToUint(char digit)
     return static_cast<unsigned int>(digit - '0');
 }
 
+static char uintToDigit(unsigned int n)
+{
+    assert(n < 10);
+    return static_cast<char>('0' + n);
+}
+
 BigNum::BigNum()
 {
 }
@@ -132,7 +221,26 @@ BigNum::BigNum(std::string s)
         digits.push_back('0');
     }
 
-    removeLeadingAndTrailingZeroes();
+    normalize();
+
+    size_t leastSignificant = 0;
+    size_t mostSignificant = 0;
+    if (!findSignificantDigits(leastSignificant, mostSignificant))
+    {
+        hasNegativeSign = false; // "-0" is zero
+    }
+}
+
+template <typename UnsignedInteger, typename SignedInteger>
+static UnsignedInteger unsignedMagnitude(SignedInteger n)
+{
+    return (n < 0) ? (UnsignedInteger(0) - static_cast<UnsignedInteger>(n)) : static_cast<UnsignedInteger>(n);
+}
+
+BigNum::BigNum(int n)
+    : digits(uintToChars(unsignedMagnitude<unsigned int>(n)))
+    , hasNegativeSign(n < 0)
+{
 }
 
 BigNum::BigNum(unsigned int n)
@@ -140,95 +248,142 @@ BigNum::BigNum(unsigned int n)
 {
 }
 
-void BigNum::forceZero()
+BigNum::BigNum(long n)
+    : digits(uintToChars(unsignedMagnitude<unsigned long>(n)))
+    , hasNegativeSign(n < 0)
 {
-    assert(false);
-    digits.resize(1, '0');
 }
 
-void BigNum::removeLeadingAndTrailingZeroes()
+BigNum::BigNum(unsigned long n)
+    : digits(uintToChars(n))
 {
-    *this = removeLeadingZeroes().removeTrailingZeroes();
 }
 
-BigNum BigNum::removeLeadingZeroes() const
+BigNum::BigNum(long long n)
+    : digits(uintToChars(unsignedMagnitude<unsigned long long>(n)))
+    , hasNegativeSign(n < 0)
 {
-    BigNum result = *this;
+}
 
-    size_t numZeroesOnLeft = 0;
-    for (auto it = result.digits.rbegin(); it != result.digits.rend(); ++it)
-    {
-        if (digitToUint(*it) != 0)
-        {
-            break;
-        }
+BigNum::BigNum(unsigned long long n)
+    : digits(uintToChars(n))
+{
+}
 
-        ++numZeroesOnLeft;
-    }
+#ifdef __SIZEOF_INT128__
+BigNum::BigNum(__int128 n)
+    : digits(uintToChars(unsignedMagnitude<unsigned __int128>(n)))
+    , hasNegativeSign(n < 0)
+{
+}
+
+BigNum::BigNum(unsigned __int128 n)
+    : digits(uintToChars(n))
+{
+}
+#endif
+
+BigNum::BigNum(double n)
+    : BigNum(fromFloatingPoint(n))
+{
+}
+
+BigNum::BigNum(long double n)
+    : BigNum(fromFloatingPoint(n))
+{
+}
 
-    if (numZeroesOnLeft == result.numDigits())
+void BigNum::forceZero()
+{
+    assert(false);
+    digits.resize(1, '0');
+}
+
+size_t BigNum::numLeadingPaddingZeroes() const
+{
+    // Zeroes before the units digit
+    size_t count = 0;
+    while (((count + decimalPosition + 1) < numStoredDigits()) && (digits[numStoredDigits() - 1 - count] == '0'))
     {
-        result.digits.resize(1, '0');
-        result.decimalPosition = 0;
+        ++count;
     }
-    else
-    {
-        size_t numLeadingZeroesToDiscard = std::min(numDigitsBeforeDecimal() - 1, numZeroesOnLeft);
 
-        result.digits.erase(result.digits.end() - numLeadingZeroesToDiscard, result.digits.end());
+    return count;
+}
+
+size_t BigNum::numTrailingPaddingZeroes() const
+{
+    // Zeroes after the last significant digit after the decimal
+    size_t count = 0;
+    while ((count < decimalPosition) && (count < numStoredDigits()) && (digits[count] == '0'))
+    {
+        ++count;
     }
 
-    return result;
+    return count;
 }
 
-BigNum BigNum::removeTrailingZeroes() const
+void BigNum::normalize()
 {
-    BigNum result = *this;
-
-    size_t numZeroesOnRight = 0;
-    for (size_t i = 0; i < numDigits(); ++i)
+    size_t numLeadingZeroes = numLeadingPaddingZeroes();
+    if (numLeadingZeroes > 0)
     {
-        if (digitAt(i) != 0)
-        {
-            break;
-        }
-
-        ++numZeroesOnRight;
+        digits.eraseRange(numStoredDigits() - numLeadingZeroes, numStoredDigits());
     }
 
-    if (numZeroesOnRight == numDigits())
+    size_t numTrailingZeroes = numTrailingPaddingZeroes();
+    if (numTrailingZeroes > 0)
     {
-        result.digits.resize(1, '0');
-        result.decimalPosition = 0;
-        return result;
+        digits.eraseRange(0, numTrailingZeroes);
+        decimalPosition -= numTrailingZeroes;
     }
 
-    size_t numTrailingZeroesToDiscard = std::min(numZeroesOnRight, result.numDigitsAfterDecimal());
+    normalized = true;
+}
 
-    if (numTrailingZeroesToDiscard > 0)
+void BigNum::normalizeIfPadded()
+{
+    if (normalized)
     {
-        if (decimalPosition < numTrailingZeroesToDiscard)
-        {
-            result.decimalPosition = 0;
-        }
-        else
-        {
-            result.decimalPosition -= numTrailingZeroesToDiscard;
-        }
-
-        size_t numDigitsAfterDiscardingTrailingZeroes = result.numDigits() - numTrailingZeroesToDiscard;
+        return;
+    }
 
-        std::vector<char> newDigits(numDigitsAfterDiscardingTrailingZeroes);
+    size_t padding = numLeadingPaddingZeroes() + numTrailingPaddingZeroes();
 
-        for (size_t i = 0; i < numDigitsAfterDiscardingTrailingZeroes; ++i)
-        {
-            newDigits[i] = digits[i + numTrailingZeroesToDiscard];
-        }
+    if (padding == 0)
+    {
+        normalized = true;
+    }
+    else if (padding > PaddingThreshold)
+    {
+        normalize();
+    }
+}
 
-        result.digits = std::move(newDigits);
+std::vector<char>& BigNum::SharedDigits::mutate()
+{
+    if (!storage)
+    {
+        storage = std::make_shared<std::vector<char>>();
+    }
+    else if (storage.use_count() == 1)
+    {
+        // use_count() is a relaxed load. Another owner releases its reference with a release
+        // decrement, so this fence orders its last reads of the digits before our writes.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    else
+    {
+        storage = std::make_shared<std::vector<char>>(*storage);
     }
 
-    return result;
+    return *storage;
+}
+
+const std::vector<char>& BigNum::SharedDigits::noDigits()
+{
+    static const std::vector<char> none;
+    return none;
 }
 
 bool BigNum::isPositive() const
@@ -241,24 +396,137 @@ bool BigNum::isNegative() const
     return hasNegativeSign;
 }
 
+bool BigNum::isInteger() const
+{
+    for (size_t i = 0; i < decimalPosition; ++i)
+    {
+        if (storedDigitAt(i) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 size_t BigNum::numDigits() const
 {
-    return digits.size();
+    if (normalized)
+    {
+        return numStoredDigits();
+    }
+
+    return numStoredDigits() - numLeadingPaddingZeroes() - numTrailingPaddingZeroes();
 }
 
 size_t BigNum::numDigitsBeforeDecimal() const
 {
-    return numDigits() - decimalPosition;
+    return numDigits() - getDecimalPosition();
 }
 
 size_t BigNum::numDigitsAfterDecimal() const
 {
-    return numDigits() - numDigitsBeforeDecimal();
+    return getDecimalPosition();
 }
 
 size_t BigNum::getDecimalPosition() const
 {
-    return decimalPosition;
+    if (normalized)
+    {
+        return decimalPosition;
+    }
+
+    return decimalPosition - numTrailingPaddingZeroes();
+}
+
+size_t BigNum::numStoredDigits() const
+{
+    return digits.size();
+}
+
+bool BigNum::isZero() const
+{
+    for (size_t i = numStoredDigits(); i > 0; --i)
+    {
+        if (digits[i - 1] != '0')
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BigNum::findSignificantDigits(size_t& leastSignificant, size_t& mostSignificant) const
+{
+    size_t numZeroesOnLeft = 0;
+    while ((numZeroesOnLeft < numStoredDigits()) && (digits[numStoredDigits() - 1 - numZeroesOnLeft] == '0'))
+    {
+        ++numZeroesOnLeft;
+    }
+
+    if (numZeroesOnLeft == numStoredDigits())
+    {
+        return false;
+    }
+
+    mostSignificant = numStoredDigits() - 1 - numZeroesOnLeft;
+
+    leastSignificant = 0;
+    while (digits[leastSignificant] == '0')
+    {
+        ++leastSignificant;
+    }
+
+    return true;
+}
+
+size_t BigNum::hash() const
+{
+    size_t cached = cachedHash.value.load(std::memory_order_relaxed);
+    if (cached != 0)
+    {
+        return cached;
+    }
+
+    // FNV-1a over the significant digits, followed by the power of 10 of the
+    // least significant one and the sign, so trailing and leading zeroes don't matter
+    std::uint64_t result = 14695981039346656037ull;
+
+    auto mix = [&result](std::uint64_t value)
+    {
+        result ^= value;
+        result *= 1099511628211ull;
+    };
+
+    size_t leastSignificant = 0;
+    size_t mostSignificant = 0;
+
+    if (findSignificantDigits(leastSignificant, mostSignificant))
+    {
+        for (size_t i = mostSignificant + 1; i > leastSignificant; --i)
+        {
+            mix(digitToUint(digits[i - 1]));
+        }
+
+        std::uint64_t exponent = static_cast<std::uint64_t>(leastSignificant) - static_cast<std::uint64_t>(decimalPosition);
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            mix((exponent >> shift) & 0xFF);
+        }
+
+        mix(isNegative() ? 1 : 0);
+    }
+
+    size_t computed = static_cast<size_t>(result ^ (result >> 32));
+    if (computed == 0)
+    {
+        computed = 1;
+    }
+
+    cachedHash.value.store(computed, std::memory_order_relaxed);
+
+    return computed;
 }
 
 unsigned int BigNum::digitAt(size_t i) const
@@ -269,6 +537,16 @@ unsigned int BigNum::digitAt(size_t i) const
         return 0;
     }
 
+    return storedDigitAt(normalized ? i : (i + numTrailingPaddingZeroes()));
+}
+
+unsigned int BigNum::storedDigitAt(size_t i) const
+{
+    if (i >= numStoredDigits())
+    {
+        return 0;
+    }
+
     return digitToUint(digits[i]);
 }
 
@@ -280,462 +558,2207 @@ BigNum BigNum::multPower10(size_t power10) const
     {
         result = *this;
         result.decimalPosition = this->decimalPosition - power10;
+        result.normalized = false; // trailing zeroes after the decimal may now be leading zeroes of the integer part
     }
     else
     {
-        std::vector<char> zeroes(power10 - this->decimalPosition, '0');
-
         result.hasNegativeSign = this->hasNegativeSign;
-
-        result.digits.reserve(zeroes.size() + this->digits.size());
-
-        result.digits.insert(result.digits.end(), zeroes.begin(), zeroes.end());
-        result.digits.insert(result.digits.end(), this->digits.begin(), this->digits.end());
+        result.digits = paddedDigits(power10 - this->decimalPosition, this->digits.get(), 0);
     }
 
-    return result.removeTrailingZeroes();
+    result.normalizeIfPadded();
+
+    return result;
 }
 
 BigNum BigNum::dividePower10(size_t power10) const
 {
     BigNum result;
 
-    if ((this->decimalPosition + power10) < numDigits())
+    if ((this->decimalPosition + power10) < numStoredDigits())
     {
         result = *this;
         result.decimalPosition = this->decimalPosition + power10;
+        result.normalized = false; // trailing zeroes of the integer part may now be after the decimal
     }
     else
     {
-        std::vector<char> zeroes((this->decimalPosition + power10) - (numDigits() - 1), '0');
-
         result.hasNegativeSign = this->hasNegativeSign;
-
-        result.digits.reserve(this->digits.size() + zeroes.size());
-
-        result.digits.insert(result.digits.end(), this->digits.begin(), this->digits.end());
-        result.digits.insert(result.digits.end(), zeroes.begin(), zeroes.end());
-
-        result.decimalPosition = result.numDigits() - zeroes.size();
+        result.digits = paddedDigits(0, this->digits.get(), (this->decimalPosition + power10) - (numStoredDigits() - 1));
+        result.decimalPosition = this->decimalPosition + power10;
     }
 
     return result;
 }
 
-std::string BigNum::display() const
-{
-    std::vector<char> displayed;
+// Slots are filled with a compare-and-swap so that readers never take a lock. The
+// cached powers live as long as the process, as copies handed out share their digits.
+static std::atomic<const BigNum*> cachedPowersOf10[BigNum::PowerOf10CacheSize + 1];
+static std::atomic<const BigNum*> cachedReciprocalPowersOf10[BigNum::PowerOf10CacheSize + 1];
 
-    displayed.reserve(numDigits() + 3); // reserve space for possible negative sign, decimal, and null terminator
-
-    if (isNegative())
+static BigNum shiftedOne(std::atomic<const BigNum*>* cache, BigNum (BigNum::*shift)(size_t) const, size_t power10)
+{
+    if (power10 > BigNum::PowerOf10CacheSize)
     {
-        displayed.push_back('-');
+        return (BigNum(1).*shift)(power10);
     }
 
-    std::vector<char> reversed = digits;
-    std::reverse(reversed.begin(), reversed.end());
-
-    displayed.insert(displayed.end(), reversed.begin(), reversed.end());
+    std::atomic<const BigNum*>& slot = cache[power10];
+    const BigNum* power = slot.load(std::memory_order_acquire);
 
-    if (decimalPosition != 0)
+    if (power == nullptr)
     {
-        displayed.insert(displayed.end() - decimalPosition, '.');
+        const BigNum* made = new BigNum((BigNum(1).*shift)(power10));
+
+        if (slot.compare_exchange_strong(power, made, std::memory_order_acq_rel))
+        {
+            power = made;
+        }
+        else
+        {
+            delete made; // another thread filled the slot first
+        }
     }
 
-    displayed.push_back('\0');
+    return *power;
+}
 
-    return displayed.data();
+BigNum BigNum::powerOf10(size_t power10)
+{
+    return shiftedOne(cachedPowersOf10, &BigNum::multPower10, power10);
 }
 
-bool operator<(const BigNum& a, const BigNum& b)
+BigNum BigNum::reciprocalPowerOf10(size_t power10)
 {
-    return !(a >= b);
+    return shiftedOne(cachedReciprocalPowersOf10, &BigNum::dividePower10, power10);
 }
 
-bool operator<=(const BigNum& a, const BigNum& b)
+// Decimal digits are grouped into base 10^9 chunks when converting to and from
+// base 2^32 words, so that every step of the conversion fits in 64 bits
+static const std::uint64_t ChunkBase = 1000000000;
+static const size_t ChunkDigits = 9;
+static const std::uint64_t WordBase = std::uint64_t(1) << 32;
+
+static size_t popcountWord(std::uint32_t word)
 {
-    return !(a > b);
+    word = word - ((word >> 1) & 0x55555555u);
+    word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+    word = (word + (word >> 4)) & 0x0F0F0F0Fu;
+
+    return static_cast<size_t>((word * 0x01010101u) >> 24);
 }
 
-bool operator==(const BigNum& a, const BigNum& b)
+static size_t bitLengthOfWords(const std::vector<std::uint32_t>& words)
 {
-    if (a.isNegative() && b.isPositive())
+    for (size_t i = words.size(); i > 0; --i)
     {
-        return false;
-    }
+        std::uint32_t word = words[i - 1];
+        if (word != 0)
+        {
+            size_t bits = 0;
+            while (word != 0)
+            {
+                ++bits;
+                word >>= 1;
+            }
 
-    if (a.isPositive() && b.isNegative())
-    {
-        return false;
+            return (32 * (i - 1)) + bits;
+        }
     }
 
-    if (a.numDigits() != b.numDigits())
+    return 0;
+}
+
+static void decrementWords(std::vector<std::uint32_t>& words)
+{
+    for (std::uint32_t& word : words)
     {
-        return false;
+        if (word-- != 0)
+        {
+            return;
+        }
     }
+}
+
+static void makeTwosComplement(std::vector<std::uint32_t>& magnitudeWords, bool negative, size_t numWords)
+{
+    assert(magnitudeWords.size() < numWords);
+
+    magnitudeWords.resize(numWords, 0);
 
-    for (size_t i = 0; i < a.numDigits(); ++i)
+    if (negative)
     {
-        if (a.digitAt(i) != b.digitAt(i))
+        std::uint64_t carry = 1;
+        for (std::uint32_t& word : magnitudeWords)
         {
-            return false;
+            carry += static_cast<std::uint32_t>(~word);
+            word = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
         }
     }
-
-    return true;
 }
 
-bool operator!=(const BigNum& a, const BigNum& b)
+std::vector<std::uint32_t> BigNum::integerWords() const
 {
-    return !(a == b);
-}
+    std::vector<std::uint64_t> chunks; // most significant first
+    chunks.reserve(((numStoredDigits() - decimalPosition) / ChunkDigits) + 1);
+
+    std::uint64_t chunk = 0;
+    for (size_t i = numStoredDigits(); i > decimalPosition; --i)
+    {
+        chunk = (chunk * 10) + digitToUint(digits[i - 1]);
+
+        if (((i - 1 - decimalPosition) % ChunkDigits) == 0)
+        {
+            chunks.push_back(chunk);
+            chunk = 0;
+        }
+    }
+
+    std::vector<std::uint32_t> words;
+    words.reserve(((numStoredDigits() - decimalPosition) / 9) + 1);
+
+    ProgressScope progress(chunks.size());
+
+    size_t firstNonZeroChunk = 0;
+    while (firstNonZeroChunk < chunks.size())
+    {
+        if ((words.size() % ProgressInterval) == 0)
+        {
+            progress.report(firstNonZeroChunk);
+        }
+
+        std::uint64_t remainder = 0;
+        for (size_t i = firstNonZeroChunk; i < chunks.size(); ++i)
+        {
+            std::uint64_t current = (remainder * ChunkBase) + chunks[i];
+            chunks[i] = current / WordBase;
+            remainder = current % WordBase;
+        }
+
+        words.push_back(static_cast<std::uint32_t>(remainder));
+
+        while ((firstNonZeroChunk < chunks.size()) && (chunks[firstNonZeroChunk] == 0))
+        {
+            ++firstNonZeroChunk;
+        }
+    }
+
+    return words;
+}
+
+BigNum BigNum::fromIntegerWords(const std::vector<std::uint32_t>& words, bool negative)
+{
+    std::vector<std::uint64_t> chunks; // least significant first
+    chunks.reserve(words.size() + 1);
+
+    ProgressScope progress(words.size());
+
+    for (auto it = words.rbegin(); it != words.rend(); ++it)
+    {
+        size_t numWordsDone = static_cast<size_t>(it - words.rbegin());
+        if ((numWordsDone % ProgressInterval) == 0)
+        {
+            progress.report(numWordsDone);
+        }
+
+        std::uint64_t carry = *it;
+        for (std::uint64_t& chunk : chunks)
+        {
+            std::uint64_t current = (chunk * WordBase) + carry;
+            chunk = current % ChunkBase;
+            carry = current / ChunkBase;
+        }
+
+        while (carry != 0)
+        {
+            chunks.push_back(carry % ChunkBase);
+            carry /= ChunkBase;
+        }
+    }
+
+    BigNum result;
+    result.digits.reserve((chunks.size() * ChunkDigits) + 1);
+
+    for (std::uint64_t chunk : chunks)
+    {
+        for (size_t i = 0; i < ChunkDigits; ++i)
+        {
+            result.digits.push_back(uintToDigit(static_cast<unsigned int>(chunk % 10)));
+            chunk /= 10;
+        }
+    }
+
+    if (result.digits.empty())
+    {
+        result.digits.push_back('0');
+    }
+
+    result.normalizeIfPadded();
+    result.hasNegativeSign = negative && !result.isZero();
+
+    return result;
+}
+
+BigNum BigNum::fromTwosComplementWords(std::vector<std::uint32_t> words)
+{
+    bool negative = !words.empty() && ((words.back() & 0x80000000u) != 0);
+
+    if (negative)
+    {
+        decrementWords(words);
+
+        for (std::uint32_t& word : words)
+        {
+            word = ~word;
+        }
+    }
+
+    return fromIntegerWords(words, negative);
+}
+
+BigNum BigNum::fromBytes(const std::vector<unsigned char>& bytes)
+{
+    std::vector<std::uint32_t> words((bytes.size() + 3) / 4, 0);
+
+    size_t byteIndex = 0;
+    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it, ++byteIndex)
+    {
+        words[byteIndex / 4] |= static_cast<std::uint32_t>(*it) << (8 * (byteIndex % 4));
+    }
+
+    if (!bytes.empty() && ((bytes.front() & 0x80) != 0))
+    {
+        for (; byteIndex < (4 * words.size()); ++byteIndex)
+        {
+            words[byteIndex / 4] |= std::uint32_t(0xFF) << (8 * (byteIndex % 4));
+        }
+    }
+
+    return fromTwosComplementWords(std::move(words));
+}
+
+std::vector<unsigned char> BigNum::toBytes() const
+{
+    if (!isInteger())
+    {
+        return integerPart().toBytes();
+    }
+
+    std::vector<std::uint32_t> words = integerWords();
+    makeTwosComplement(words, isNegative(), words.size() + 1);
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(4 * words.size());
+
+    for (auto it = words.rbegin(); it != words.rend(); ++it)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            bytes.push_back(static_cast<unsigned char>(*it >> shift));
+        }
+    }
+
+    unsigned char signByte = isNegative() ? 0xFF : 0x00;
+
+    size_t numRedundantBytes = 0;
+    while ((numRedundantBytes + 1 < bytes.size()) &&
+           (bytes[numRedundantBytes] == signByte) &&
+           ((bytes[numRedundantBytes + 1] & 0x80) == (signByte & 0x80)))
+    {
+        ++numRedundantBytes;
+    }
+
+    bytes.erase(bytes.begin(), bytes.begin() + numRedundantBytes);
+
+    return bytes;
+}
+
+size_t BigNum::popcount() const
+{
+    if (!isInteger())
+    {
+        return integerPart().popcount();
+    }
+
+    std::vector<std::uint32_t> words = integerWords();
+
+    if (isNegative())
+    {
+        decrementWords(words);
+    }
+
+    size_t count = 0;
+    for (std::uint32_t word : words)
+    {
+        count += popcountWord(word);
+    }
+
+    return count;
+}
+
+size_t BigNum::bitLength() const
+{
+    if (!isInteger())
+    {
+        return integerPart().bitLength();
+    }
+
+    std::vector<std::uint32_t> words = integerWords();
+
+    if (isNegative())
+    {
+        decrementWords(words);
+    }
+
+    return bitLengthOfWords(words);
+}
+
+bool BigNum::testBit(size_t bit) const
+{
+    if (!isInteger())
+    {
+        return integerPart().testBit(bit);
+    }
+
+    std::vector<std::uint32_t> words = integerWords();
+
+    if (isNegative())
+    {
+        decrementWords(words);
+    }
+
+    bool isSet = ((bit / 32) < words.size()) && (((words[bit / 32] >> (bit % 32)) & 1) != 0);
+
+    return (isSet != isNegative());
+}
+
+BigNum BigNum::setBit(size_t bit) const
+{
+    return (*this | (BigNum(1u) << bit));
+}
+
+static void multiplyDigits(std::vector<char>& digits, std::uint32_t factor)
+{
+    std::uint64_t carry = 0;
+    for (char& digit : digits)
+    {
+        carry += static_cast<std::uint64_t>(digitToUint(digit)) * factor;
+        digit = uintToDigit(static_cast<unsigned int>(carry % 10));
+        carry /= 10;
+    }
+
+    while (carry != 0)
+    {
+        digits.push_back(uintToDigit(static_cast<unsigned int>(carry % 10)));
+        carry /= 10;
+    }
+}
+
+static bool wordBit(const std::vector<std::uint32_t>& words, size_t bit)
+{
+    return (((words[bit / 32] >> (bit % 32)) & 1) != 0);
+}
+
+BigNum BigNum::fromFloatingPoint(long double n)
+{
+    if (!std::isfinite(n))
+    {
+        assert(false);
+        return BigNum(0u);
+    }
+
+    int exponent = 0;
+    long double fraction = std::frexp(std::fabs(n), &exponent);
+
+    // Peel the significand off 32 bits at a time, so that |n| == significand * 2^exponent
+    std::vector<std::uint32_t> significand;
+
+    while (fraction != 0)
+    {
+        fraction = std::ldexp(fraction, 32);
+
+        long double word = std::floor(fraction);
+        significand.push_back(static_cast<std::uint32_t>(word));
+
+        fraction -= word;
+        exponent -= 32;
+    }
+
+    std::reverse(significand.begin(), significand.end());
+
+    BigNum result = fromIntegerWords(significand, false);
+
+    if (exponent >= 0)
+    {
+        result <<= static_cast<size_t>(exponent);
+    }
+    else
+    {
+        // significand / 2^k == significand * 5^k / 10^k, which is exact in decimal
+        size_t power5 = static_cast<size_t>(-exponent);
+
+        const size_t maxPower5PerStep = 13; // 5^13 fits in 32 bits
+        for (size_t remaining = power5; remaining > 0; remaining -= std::min(remaining, maxPower5PerStep))
+        {
+            std::uint32_t factor = 1;
+            for (size_t i = 0; i < std::min(remaining, maxPower5PerStep); ++i)
+            {
+                factor *= 5;
+            }
+
+            multiplyDigits(result.digits.mutate(), factor);
+        }
+
+        result = result.dividePower10(power5);
+        result.normalizeIfPadded();
+    }
+
+    result.hasNegativeSign = (n < 0) && (result != BigNum(0u));
+
+    return result;
+}
+
+double BigNum::toDouble() const
+{
+    size_t numSignificantDigits = digits.size();
+    while ((numSignificantDigits > 0) && (digits[numSignificantDigits - 1] == '0'))
+    {
+        --numSignificantDigits;
+    }
+
+    double sign = isNegative() ? -1.0 : 1.0;
+
+    if (numSignificantDigits == 0)
+    {
+        return sign * 0.0;
+    }
+
+    // Numbers of 10^309 or more overflow, and numbers under 10^-324 are less than half the smallest subnormal
+    long long decimalExponent = static_cast<long long>(numSignificantDigits - 1) - static_cast<long long>(decimalPosition);
+
+    if (decimalExponent > std::numeric_limits<double>::max_exponent10)
+    {
+        return sign * std::numeric_limits<double>::infinity();
+    }
+
+    if (decimalExponent < -324)
+    {
+        return sign * 0.0;
+    }
+
+    size_t leastSignificant = 0;
+    while (digits[leastSignificant] == '0')
+    {
+        ++leastSignificant;
+    }
+
+    if ((numSignificantDigits - leastSignificant) > ToDoubleLeadingDigits)
+    {
+        // The number lies between its leading digits and the next number with that many
+        // digits. Unless a rounding boundary falls between them, both round to the answer.
+        size_t firstLeadingDigit = numSignificantDigits - ToDoubleLeadingDigits;
+
+        BigNum leading;
+        leading.digits = std::vector<char>(digits.begin() + firstLeadingDigit, digits.begin() + numSignificantDigits);
+
+        BigNum nextLeading = leading + BigNum(1u);
+
+        auto placed = [this, firstLeadingDigit](const BigNum& n)
+        {
+            return (firstLeadingDigit >= decimalPosition) ? n.multPower10(firstLeadingDigit - decimalPosition) : n.dividePower10(decimalPosition - firstLeadingDigit);
+        };
+
+        double below = placed(leading).toDouble();
+        if (below == placed(nextLeading).toDouble())
+        {
+            return sign * below;
+        }
+    }
+
+    // Scale by 2^scale so that the integer part carries comfortably more bits than a double,
+    // then round that integer, remembering whether any fractional digits were dropped
+    long long scale = std::max(0LL, 70 - static_cast<long long>(std::floor(decimalExponent * 3.321928094887362)));
+
+    BigNum scaled = abs(*this);
+
+    for (long long remaining = scale; remaining > 0; remaining -= std::min(remaining, 31LL))
+    {
+        multiplyDigits(scaled.digits.mutate(), std::uint32_t(1) << std::min(remaining, 31LL));
+    }
+
+    bool sticky = false;
+    for (size_t i = 0; i < scaled.decimalPosition; ++i)
+    {
+        sticky = sticky || (scaled.digits[i] != '0');
+    }
+
+    scaled.digits.eraseRange(0, scaled.decimalPosition);
+    scaled.decimalPosition = 0;
+
+    std::vector<std::uint32_t> words = scaled.integerWords();
+
+    long long bitLength = static_cast<long long>(bitLengthOfWords(words));
+    long long binaryExponent = bitLength - 1 - scale;
+
+    if (binaryExponent >= std::numeric_limits<double>::max_exponent)
+    {
+        return sign * std::numeric_limits<double>::infinity();
+    }
+
+    // Subnormal results have fewer bits of precision
+    long long precision = std::numeric_limits<double>::digits;
+    long long minExponent = std::numeric_limits<double>::min_exponent - 1;
+
+    if (binaryExponent < minExponent)
+    {
+        precision -= (minExponent - binaryExponent);
+    }
+
+    if (precision < 0)
+    {
+        return sign * 0.0;
+    }
+
+    long long numDroppedBits = bitLength - precision;
+    assert(numDroppedBits > 0);
+
+    std::uint64_t mantissa = 0;
+    for (long long i = bitLength - 1; i >= numDroppedBits; --i)
+    {
+        mantissa = (mantissa << 1) | (wordBit(words, static_cast<size_t>(i)) ? 1 : 0);
+    }
+
+    bool half = wordBit(words, static_cast<size_t>(numDroppedBits - 1));
+
+    bool aboveHalf = sticky;
+    for (long long i = 0; !aboveHalf && (i < numDroppedBits - 1); ++i)
+    {
+        aboveHalf = wordBit(words, static_cast<size_t>(i));
+    }
+
+    if (half && (aboveHalf || ((mantissa & 1) != 0)))
+    {
+        ++mantissa;
+    }
+
+    return sign * std::ldexp(static_cast<double>(mantissa), static_cast<int>(numDroppedBits - scale));
+}
+
+namespace
+{
+    class DisplayBuffer
+    {
+    public:
+        explicit DisplayBuffer(const BigNum::DisplaySink& sink)
+            : sink(sink)
+        {
+            buffer.reserve(BigNum::DisplayChunkSize);
+        }
+
+        void push(char c)
+        {
+            buffer.push_back(c);
+
+            if (buffer.size() == BigNum::DisplayChunkSize)
+            {
+                flush();
+            }
+        }
+
+        void push(const std::string& s)
+        {
+            for (char c : s)
+            {
+                push(c);
+            }
+        }
+
+        // Called explicitly rather than from a destructor, so that a sink that throws
+        // isn't called again with the same chars while the exception unwinds
+        void flush()
+        {
+            if (!buffer.empty())
+            {
+                sink(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+
+    private:
+        const BigNum::DisplaySink& sink;
+        std::vector<char> buffer;
+    };
+}
+
+std::string BigNum::display() const
+{
+    return display(DisplayFormat());
+}
+
+std::string BigNum::display(const DisplayFormat& format) const
+{
+    std::string displayed;
+
+    displayed.reserve(numStoredDigits() + 2); // reserve space for possible negative sign and decimal
+
+    display([&displayed](const char* chars, size_t numChars) { displayed.append(chars, numChars); }, format);
+
+    return displayed;
+}
+
+void BigNum::display(std::ostream& out) const
+{
+    display(out, DisplayFormat());
+}
+
+void BigNum::display(std::ostream& out, const DisplayFormat& format) const
+{
+    display([&out](const char* chars, size_t numChars) { out.write(chars, static_cast<std::streamsize>(numChars)); }, format);
+}
+
+void BigNum::display(const DisplaySink& sink) const
+{
+    display(sink, DisplayFormat());
+}
+
+void BigNum::display(const DisplaySink& sink, const DisplayFormat& format) const
+{
+    DisplayBuffer buffer(sink);
+
+    if (isNegative())
+    {
+        buffer.push('-');
+    }
+
+    if (format.scientific)
+    {
+        size_t numZeroesOnLeft = 0;
+        while ((numZeroesOnLeft < numStoredDigits()) && (storedDigitAt(numStoredDigits() - 1 - numZeroesOnLeft) == 0))
+        {
+            ++numZeroesOnLeft;
+        }
+
+        if (numZeroesOnLeft == numStoredDigits())
+        {
+            buffer.push("0e0");
+            buffer.flush();
+            return;
+        }
+
+        size_t mostSignificant = numStoredDigits() - 1 - numZeroesOnLeft;
+
+        size_t leastSignificant = 0;
+        while (storedDigitAt(leastSignificant) == 0)
+        {
+            ++leastSignificant;
+        }
+
+        ProgressScope progress((mostSignificant - leastSignificant) + 1);
+
+        buffer.push(digits[mostSignificant]);
+
+        if (leastSignificant < mostSignificant)
+        {
+            buffer.push('.');
+
+            for (size_t i = mostSignificant; i > leastSignificant; --i)
+            {
+                if (((mostSignificant - i) % ProgressInterval) == 0)
+                {
+                    progress.report(mostSignificant - i);
+                }
+
+                buffer.push(digits[i - 1]);
+            }
+        }
+
+        buffer.push('e');
+        buffer.push(std::to_string(static_cast<long long>(mostSignificant) - static_cast<long long>(decimalPosition)));
+        buffer.flush();
+
+        return;
+    }
+
+    bool grouped = (format.groupSeparator != '\0') && (format.groupSize > 0);
+
+    // Zero padding left over from arithmetic is skipped rather than trimmed
+    size_t numLeadingZeroes = normalized ? 0 : numLeadingPaddingZeroes();
+    size_t numTrailingZeroes = normalized ? 0 : numTrailingPaddingZeroes();
+
+    size_t numDisplayedDigits = numStoredDigits() - numLeadingZeroes;
+
+    ProgressScope progress(numDisplayedDigits - numTrailingZeroes);
+
+    for (size_t i = numDisplayedDigits; i > decimalPosition; --i)
+    {
+        if (((numDisplayedDigits - i) % ProgressInterval) == 0)
+        {
+            progress.report(numDisplayedDigits - i);
+        }
+
+        size_t powerOf10 = i - 1 - decimalPosition;
+
+        if (grouped && (i != numDisplayedDigits) && (((powerOf10 + 1) % format.groupSize) == 0))
+        {
+            buffer.push(format.groupSeparator);
+        }
+
+        buffer.push(digits[i - 1]);
+    }
+
+    if (decimalPosition > numTrailingZeroes)
+    {
+        buffer.push('.');
+
+        for (size_t i = decimalPosition; i > numTrailingZeroes; --i)
+        {
+            if (((numDisplayedDigits - i) % ProgressInterval) == 0)
+            {
+                progress.report(numDisplayedDigits - i);
+            }
+
+            buffer.push(digits[i - 1]);
+        }
+    }
+
+    buffer.flush();
+}
+
+bool operator<(const BigNum& a, const BigNum& b)
+{
+    return !(a >= b);
+}
+
+bool operator<=(const BigNum& a, const BigNum& b)
+{
+    return !(a > b);
+}
+
+bool operator==(const BigNum& a, const BigNum& b)
+{
+    size_t aHash = a.cachedHash.value.load(std::memory_order_relaxed);
+    size_t bHash = b.cachedHash.value.load(std::memory_order_relaxed);
+
+    if ((aHash != 0) && (bHash != 0) && (aHash != bHash))
+    {
+        return false;
+    }
+
+    size_t aLeastSignificant = 0;
+    size_t aMostSignificant = 0;
+    bool aIsZero = !a.findSignificantDigits(aLeastSignificant, aMostSignificant);
+
+    size_t bLeastSignificant = 0;
+    size_t bMostSignificant = 0;
+    bool bIsZero = !b.findSignificantDigits(bLeastSignificant, bMostSignificant);
+
+    if (aIsZero || bIsZero)
+    {
+        return (aIsZero && bIsZero);
+    }
+
+    if (a.isNegative() != b.isNegative())
+    {
+        return false;
+    }
+
+    // The significant digits must line up at the same power of 10 and have the same length
+    if ((aLeastSignificant + b.decimalPosition) != (bLeastSignificant + a.decimalPosition))
+    {
+        return false;
+    }
+
+    if ((aMostSignificant - aLeastSignificant) != (bMostSignificant - bLeastSignificant))
+    {
+        return false;
+    }
+
+    return std::equal(a.digits.begin() + aLeastSignificant, a.digits.begin() + aMostSignificant + 1, b.digits.begin() + bLeastSignificant);
+}
+
+bool operator!=(const BigNum& a, const BigNum& b)
+{
+    return !(a == b);
+}
+
+int BigNum::compare(const BigNum& a, const BigNum& b)
+{
+    size_t aLeastSignificant = 0;
+    size_t aMostSignificant = 0;
+    bool aIsZero = !a.findSignificantDigits(aLeastSignificant, aMostSignificant);
+
+    size_t bLeastSignificant = 0;
+    size_t bMostSignificant = 0;
+    bool bIsZero = !b.findSignificantDigits(bLeastSignificant, bMostSignificant);
+
+    int aSign = aIsZero ? 0 : (a.isNegative() ? -1 : 1);
+    int bSign = bIsZero ? 0 : (b.isNegative() ? -1 : 1);
+
+    if ((aSign != bSign) || (aSign == 0))
+    {
+        return (aSign < bSign) ? -1 : ((aSign > bSign) ? 1 : 0);
+    }
+
+    // Walk the significant digits down from the highest power of 10, so that neither
+    // the padding nor the difference in decimal positions needs to be copied away
+    long long aHighestPower = static_cast<long long>(aMostSignificant) - static_cast<long long>(a.decimalPosition);
+    long long bHighestPower = static_cast<long long>(bMostSignificant) - static_cast<long long>(b.decimalPosition);
+
+    if (aHighestPower != bHighestPower)
+    {
+        return (aHighestPower > bHighestPower) ? aSign : -aSign;
+    }
+
+    long long lowestPower = std::min(static_cast<long long>(aLeastSignificant) - static_cast<long long>(a.decimalPosition),
+                                     static_cast<long long>(bLeastSignificant) - static_cast<long long>(b.decimalPosition));
+
+    auto digitAtPower = [](const BigNum& n, long long power)
+    {
+        long long i = power + static_cast<long long>(n.decimalPosition);
+        return (i < 0) ? 0u : n.storedDigitAt(static_cast<size_t>(i));
+    };
+
+    for (long long power = aHighestPower; power >= lowestPower; --power)
+    {
+        unsigned int aDigit = digitAtPower(a, power);
+        unsigned int bDigit = digitAtPower(b, power);
+
+        if (aDigit != bDigit)
+        {
+            return (aDigit > bDigit) ? aSign : -aSign;
+        }
+    }
+
+    return 0;
+}
 
 bool operator>(const BigNum& a, const BigNum& b)
+{
+    return (BigNum::compare(a, b) > 0);
+}
+
+bool operator>=(const BigNum& a, const BigNum& b)
+{
+    return (BigNum::compare(a, b) >= 0);
+}
+
+BigNum operator+(const BigNum& a, const BigNum& b)
+{
+    if (a.isNegative() && b.isPositive())
+    {
+        return (b - -(a));
+    }
+
+    if (a.isPositive() && b.isNegative())
+    {
+        return (a - -(b));
+    }
+
+    if (a.isNegative() && b.isNegative())
+    {
+        return -(-(a) + -(b));
+    }
+
+    std::pair<BigNum, BigNum> decimalsLinedUp = BigNum::makeWithLinedUpDecimalPositions(a, b);
+
+    size_t maxDigits = std::max(decimalsLinedUp.first.numStoredDigits(), decimalsLinedUp.second.numStoredDigits());
+
+    BigNum result;
+    result.digits.reserve(maxDigits + 1);
+
+    unsigned int carry = 0;
+    for (size_t i = 0; i < maxDigits; ++i)
+    {
+        unsigned int currentSum = carry + decimalsLinedUp.first.storedDigitAt(i) + decimalsLinedUp.second.storedDigitAt(i);
+
+        carry = currentSum / 10;
+        result.digits.push_back(uintToDigit(currentSum % 10));
+    }
+
+    if (carry != 0)
+    {
+        result.digits.push_back(uintToDigit(carry));
+    }
+
+    result.decimalPosition = decimalsLinedUp.first.decimalPosition;
+    result.normalizeIfPadded();
+
+    return result;
+}
+
+void operator+=(BigNum& a, const BigNum& b)
+{
+    a = a + b;
+}
+
+BigNum BigNum::sumShard(const BigNum* const* begin, const BigNum* const* end)
+{
+    // Every addend goes into wide columns at an offset that lines its decimal up with
+    // the largest scale in the shard, so nothing is copied or padded and all of the
+    // carrying is deferred to one pass per sign at the end
+    size_t maxDigitsAfterDecimal = 0;
+    size_t maxDigitsBeforeDecimal = 0;
+
+    for (auto it = begin; it != end; ++it)
+    {
+        maxDigitsAfterDecimal = std::max(maxDigitsAfterDecimal, (*it)->decimalPosition);
+        maxDigitsBeforeDecimal = std::max(maxDigitsBeforeDecimal, ((*it)->numStoredDigits() - (*it)->decimalPosition));
+    }
+
+    std::vector<std::uint64_t> positiveColumns(maxDigitsAfterDecimal + maxDigitsBeforeDecimal, 0);
+    std::vector<std::uint64_t> negativeColumns(maxDigitsAfterDecimal + maxDigitsBeforeDecimal, 0);
+
+    for (auto it = begin; it != end; ++it)
+    {
+        const BigNum& addend = **it;
+
+        std::vector<std::uint64_t>& columns = addend.isNegative() ? negativeColumns : positiveColumns;
+        size_t offset = maxDigitsAfterDecimal - addend.decimalPosition;
+
+        for (size_t i = 0; i < addend.numStoredDigits(); ++i)
+        {
+            columns[i + offset] += digitToUint(addend.digits[i]);
+        }
+    }
+
+    auto fromColumns = [maxDigitsAfterDecimal](const std::vector<std::uint64_t>& columns)
+    {
+        BigNum result;
+        result.digits.reserve(columns.size() + std::numeric_limits<std::uint64_t>::digits10);
+
+        std::uint64_t carry = 0;
+        for (std::uint64_t column : columns)
+        {
+            carry += column;
+            result.digits.push_back(uintToDigit(static_cast<unsigned int>(carry % 10)));
+            carry /= 10;
+        }
+
+        while (carry != 0)
+        {
+            result.digits.push_back(uintToDigit(static_cast<unsigned int>(carry % 10)));
+            carry /= 10;
+        }
+
+        if (result.digits.size() <= maxDigitsAfterDecimal)
+        {
+            result.digits.resize(maxDigitsAfterDecimal + 1, '0');
+        }
+
+        result.decimalPosition = maxDigitsAfterDecimal;
+
+        return result;
+    };
+
+    return (fromColumns(positiveColumns) - fromColumns(negativeColumns));
+}
+
+BigNum BigNum::sumAddends(const std::vector<const BigNum*>& addends, ExecutionPolicy policy)
+{
+    size_t numShards = 1;
+
+    if (policy == ExecutionPolicy::Parallel)
+    {
+        numShards = std::max(std::thread::hardware_concurrency(), 1u);
+        numShards = std::min(numShards, std::max<size_t>(addends.size() / MinAddendsPerShard, 1));
+    }
+
+    const BigNum* const* first = addends.data();
+
+    std::vector<BigNum> partialSums(numShards, BigNum::Zero);
+
+    if (numShards == 1)
+    {
+        partialSums[0] = sumShard(first, first + addends.size());
+    }
+    else
+    {
+        // An exception in a worker, e.g. bad_alloc, is handed back to the calling thread
+        std::vector<std::exception_ptr> failures(numShards);
+
+        std::vector<std::thread> threads;
+        threads.reserve(numShards);
+
+        try
+        {
+            for (size_t shard = 0; shard < numShards; ++shard)
+            {
+                size_t shardBegin = (addends.size() * shard) / numShards;
+                size_t shardEnd = (addends.size() * (shard + 1)) / numShards;
+
+                threads.emplace_back([&partialSums, &failures, first, shard, shardBegin, shardEnd]()
+                {
+                    try
+                    {
+                        partialSums[shard] = sumShard(first + shardBegin, first + shardEnd);
+                    }
+                    catch (...)
+                    {
+                        failures[shard] = std::current_exception();
+                    }
+                });
+            }
+        }
+        catch (...)
+        {
+            // A thread couldn't be started, the ones already running still have to be joined
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            throw;
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const std::exception_ptr& failure : failures)
+        {
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
+        }
+    }
+
+    // Neighbouring pairs are added level by level, so the order of additions only depends on the number of shards
+    while (partialSums.size() > 1)
+    {
+        std::vector<BigNum> nextLevel;
+        nextLevel.reserve((partialSums.size() + 1) / 2);
+
+        for (size_t i = 0; (i + 1) < partialSums.size(); i += 2)
+        {
+            nextLevel.push_back(partialSums[i] + partialSums[i + 1]);
+        }
+
+        if ((partialSums.size() % 2) != 0)
+        {
+            nextLevel.push_back(partialSums.back());
+        }
+
+        partialSums = std::move(nextLevel);
+    }
+
+    BigNum result = partialSums[0];
+    result.normalizeIfPadded();
+
+    return result;
+}
+
+BigNum operator-(const BigNum& num)
+{
+    BigNum negated = num;
+    negated.hasNegativeSign = !negated.hasNegativeSign && !num.isZero();
+
+    return negated;
+}
+
+BigNum operator-(const BigNum& a, const BigNum& b)
 {
     if (a.isNegative() && b.isPositive())
     {
-        return false;
+        return -(-(a) + b);
     }
 
     if (a.isPositive() && b.isNegative())
     {
-        return true;
+        return (a + -(b));
     }
 
     if (a.isNegative() && b.isNegative())
     {
-        return (-(a) < -(b));
+        return (-(b) - -(a));
     }
 
-    if (a.numDigitsBeforeDecimal() > b.numDigitsBeforeDecimal())
+    if (b > a)
     {
-        return true;
+        return -(b - a);
     }
 
-    if (b.numDigitsBeforeDecimal() > a.numDigitsBeforeDecimal())
+    std::pair<BigNum, BigNum> decimalsLinedUp = BigNum::makeWithLinedUpDecimalPositions(a, b);
+
+    size_t maxDigits = std::max(decimalsLinedUp.first.numStoredDigits(), decimalsLinedUp.second.numStoredDigits());
+
+    BigNum result;
+    result.digits.reserve(maxDigits);
+
+    unsigned int borrow = 0;
+    for (size_t i = 0; i < maxDigits; ++i)
     {
-        return false;
+        unsigned int subtrahend = decimalsLinedUp.second.storedDigitAt(i) + borrow;
+        unsigned int currentDifference = decimalsLinedUp.first.storedDigitAt(i);
+
+        borrow = (currentDifference < subtrahend) ? 1 : 0;
+        currentDifference = currentDifference + (10 * borrow) - subtrahend;
+
+        result.digits.push_back(uintToDigit(currentDifference));
     }
 
-    std::pair<BigNum, BigNum> decimalsLinedUp = makeWithLinedUpDecimalPositions(a, b);
+    assert(borrow == 0);
+
+    result.decimalPosition = decimalsLinedUp.first.decimalPosition;
+    result.normalizeIfPadded();
+
+    return result;
+}
+
+void operator-=(BigNum& a, const BigNum& b)
+{
+    a = a - b;
+}
+
+static bool haveDifferentSigns(const BigNum& a, const BigNum& b)
+{
+    return ((a.isNegative() && !b.isNegative()) || (!a.isNegative() && b.isNegative()));
+}
+
+BigNum operator*(const BigNum& a, const BigNum& b)
+{
+    // Schoolbook multiplication, one block of KernelBlockSize result columns at a time.
+    // Only the block's column sums are held as wide integers, so the scratch space is
+    // fixed however large the operands are, and stays resident in cache while every
+    // pair of digits that lands in the block is applied to it.
+    const std::vector<char>& aDigits = a.digits.get();
+    const std::vector<char>& bDigits = b.digits.get();
+
+    size_t decimalPosition = a.decimalPosition + b.decimalPosition;
+    size_t numColumns = std::max(aDigits.size() + bDigits.size(), decimalPosition + 1);
+
+    std::vector<char> productDigits(numColumns);
+    std::vector<unsigned long long> columns(KernelBlockSize);
 
-    auto firstIter = decimalsLinedUp.first.digits.rbegin();
-    auto secondIter = decimalsLinedUp.second.digits.rbegin();
+    size_t numBlocks = (numColumns + KernelBlockSize - 1) / KernelBlockSize;
+    ProgressScope progress(numBlocks * aDigits.size());
 
-    while (firstIter != decimalsLinedUp.first.digits.rend())
+    unsigned long long carry = 0;
+
+    for (size_t blockStart = 0; blockStart < numColumns; blockStart += KernelBlockSize)
     {
-        unsigned int firstDigit = digitToUint(*firstIter);
-        unsigned int secondDigit = digitToUint(*secondIter);
+        size_t blockEnd = std::min(blockStart + KernelBlockSize, numColumns);
+
+        std::fill(columns.begin(), columns.end(), 0);
 
-        if (firstDigit > secondDigit)
+        // Digit i of a lands in the block when multiplied by digits [blockStart - i, blockEnd - i) of b
+        size_t firstA = (blockStart >= bDigits.size()) ? (blockStart - bDigits.size() + 1) : 0;
+        size_t endA = std::min(blockEnd, aDigits.size());
+
+        for (size_t i = firstA; i < endA; ++i)
         {
-            return true;
+            if ((i % ProgressInterval) == 0)
+            {
+                progress.report(((blockStart / KernelBlockSize) * aDigits.size()) + i);
+            }
+
+            unsigned int aDigit = digitToUint(aDigits[i]);
+            if (aDigit == 0)
+            {
+                continue;
+            }
+
+            size_t firstB = (blockStart > i) ? (blockStart - i) : 0;
+            size_t endB = std::min(blockEnd - i, bDigits.size());
+
+            for (size_t j = firstB; j < endB; ++j)
+            {
+                columns[i + j - blockStart] += aDigit * digitToUint(bDigits[j]);
+            }
         }
 
-        if (firstDigit < secondDigit)
+        for (size_t k = blockStart; k < blockEnd; ++k)
         {
-            return false;
+            carry += columns[k - blockStart];
+            productDigits[k] = uintToDigit(static_cast<unsigned int>(carry % 10));
+            carry /= 10;
+        }
+    }
+
+    assert(carry == 0);
+
+    BigNum result;
+    result.digits = std::move(productDigits);
+    result.decimalPosition = decimalPosition;
+    result.normalizeIfPadded();
+
+    if (haveDifferentSigns(a, b) && !result.isZero())
+    {
+        result.hasNegativeSign = true;
+    }
+
+    return result;
+}
+
+void operator*=(BigNum& a, const BigNum& b)
+{
+    a = a * b;
+}
+
+BigNum BigNum::divide(const BigNum& a, const BigNum& b, size_t maxDigitsAfterDecimal)
+{
+    if (abs(b) == BigNum::Zero)
+    {
+        assert(false);
+        return BigNum::Zero;
+    }
+
+    // a / b == (A / 10^da) / (B / 10^db) == (A * 10^db) / (B * 10^da) for integers A and B,
+    // which is scaled by 10^maxDigitsAfterDecimal before the integer division
+    BigNum dividend = makeWithAdditionalTrailingZeroes(abs(a), b.decimalPosition + maxDigitsAfterDecimal);
+    dividend.decimalPosition = 0;
+
+    BigNum divisor = makeWithAdditionalTrailingZeroes(abs(b), a.decimalPosition);
+    divisor.decimalPosition = 0;
+
+    BigNum result = divMod(dividend, divisor).first.dividePower10(maxDigitsAfterDecimal);
+    result.normalizeIfPadded();
+    result.hasNegativeSign = haveDifferentSigns(a, b) && !result.isZero();
+
+    return result;
+}
+
+BigNum operator/(const BigNum& a, const BigNum& b)
+{
+    return BigNum::divide(a, b, BigNum::MaxDigitsAfterDecimal);
+}
+
+void operator/=(BigNum& a, const BigNum& b)
+{
+    a = a / b;
+}
+
+static void removeLeadingZeroDigits(std::vector<char>& digits)
+{
+    while (!digits.empty() && (digits.back() == '0'))
+    {
+        digits.pop_back();
+    }
+}
+
+// Groups little-endian digits into base 10^9 limbs, least significant first
+static std::vector<std::uint32_t> digitsToLimbs(const std::vector<char>& digits)
+{
+    std::vector<std::uint32_t> limbs((digits.size() + ChunkDigits - 1) / ChunkDigits, 0);
+
+    for (size_t i = digits.size(); i > 0; --i)
+    {
+        std::uint32_t& limb = limbs[(i - 1) / ChunkDigits];
+        limb = (limb * 10) + digitToUint(digits[i - 1]);
+    }
+
+    return limbs;
+}
+
+static std::vector<char> limbsToDigits(const std::vector<std::uint32_t>& limbs)
+{
+    std::vector<char> digits;
+    digits.reserve(limbs.size() * ChunkDigits);
+
+    for (std::uint32_t limb : limbs)
+    {
+        for (size_t i = 0; i < ChunkDigits; ++i)
+        {
+            digits.push_back(uintToDigit(limb % 10));
+            limb /= 10;
+        }
+    }
+
+    removeLeadingZeroDigits(digits);
+
+    return digits;
+}
+
+// Multiplies by a single limb in place, returning the limb carried out
+static std::uint32_t multiplyLimbs(std::vector<std::uint32_t>& limbs, std::uint32_t factor)
+{
+    std::uint64_t carry = 0;
+    for (std::uint32_t& limb : limbs)
+    {
+        std::uint64_t product = (static_cast<std::uint64_t>(limb) * factor) + carry;
+        limb = static_cast<std::uint32_t>(product % ChunkBase);
+        carry = product / ChunkBase;
+    }
+
+    return static_cast<std::uint32_t>(carry);
+}
+
+// Divides by a single limb in place, returning the remainder
+static std::uint32_t divideLimbs(std::vector<std::uint32_t>& limbs, std::uint32_t divisor)
+{
+    std::uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i > 0; --i)
+    {
+        std::uint64_t current = (remainder * ChunkBase) + limbs[i - 1];
+        limbs[i - 1] = static_cast<std::uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+
+    return static_cast<std::uint32_t>(remainder);
+}
+
+// Long division of little-endian digit vectors without leading zeroes, where the dividend
+// has at least as many digits as the divisor. It runs on base 10^9 limbs as in Knuth's
+// algorithm D: once both are scaled so that the divisor's leading limb is at least half
+// the base, each quotient limb estimated from the three leading limbs of the running
+// remainder is at most one too large, and is corrected with a single add back.
+static void longDivideDigits(const std::vector<char>& dividendDigits, const std::vector<char>& divisorDigits, std::vector<char>& quotientDigits, std::vector<char>& remainderDigits)
+{
+    std::vector<std::uint32_t> remainder = digitsToLimbs(dividendDigits);
+    std::vector<std::uint32_t> divisor = digitsToLimbs(divisorDigits);
+
+    size_t numDivisorLimbs = divisor.size();
+    size_t numQuotientLimbs = remainder.size() - numDivisorLimbs + 1;
+
+    std::vector<std::uint32_t> quotient(numQuotientLimbs, 0);
+
+    if (numDivisorLimbs == 1)
+    {
+        quotient = remainder;
+        remainder = { divideLimbs(quotient, divisor[0]) };
+    }
+    else
+    {
+        std::uint32_t scale = static_cast<std::uint32_t>(ChunkBase / (divisor.back() + std::uint64_t(1)));
+
+        std::uint32_t remainderCarry = multiplyLimbs(remainder, scale);
+        remainder.push_back(remainderCarry);
+        multiplyLimbs(divisor, scale);
+
+        std::uint64_t divisorLeading = divisor[numDivisorLimbs - 1];
+        std::uint64_t divisorNext = divisor[numDivisorLimbs - 2];
+
+        ProgressScope progress(numQuotientLimbs);
+
+        for (size_t j = numQuotientLimbs; j > 0; --j)
+        {
+            size_t numLimbsDone = numQuotientLimbs - j;
+            if ((numLimbsDone % ProgressInterval) == 0)
+            {
+                progress.report(numLimbsDone);
+            }
+
+            size_t position = j - 1;
+
+            std::uint64_t leading = (remainder[position + numDivisorLimbs] * ChunkBase) + remainder[position + numDivisorLimbs - 1];
+            std::uint64_t estimate = leading / divisorLeading;
+            std::uint64_t estimateRemainder = leading % divisorLeading;
+
+            while ((estimate >= ChunkBase) || ((estimate * divisorNext) > ((estimateRemainder * ChunkBase) + remainder[position + numDivisorLimbs - 2])))
+            {
+                --estimate;
+                estimateRemainder += divisorLeading;
+
+                if (estimateRemainder >= ChunkBase)
+                {
+                    break;
+                }
+            }
+
+            std::uint64_t carry = 0;
+            std::uint64_t borrow = 0;
+            for (size_t i = 0; i < numDivisorLimbs; ++i)
+            {
+                std::uint64_t product = (estimate * divisor[i]) + carry;
+                carry = product / ChunkBase;
+
+                std::uint64_t subtrahend = (product % ChunkBase) + borrow;
+                borrow = (remainder[position + i] < subtrahend) ? 1 : 0;
+                remainder[position + i] = static_cast<std::uint32_t>((remainder[position + i] + (borrow * ChunkBase)) - subtrahend);
+            }
+
+            std::uint64_t subtrahend = carry + borrow;
+            bool overshot = (remainder[position + numDivisorLimbs] < subtrahend);
+            remainder[position + numDivisorLimbs] = static_cast<std::uint32_t>(remainder[position + numDivisorLimbs] - subtrahend);
+
+            if (overshot)
+            {
+                --estimate;
+
+                std::uint64_t addCarry = 0;
+                for (size_t i = 0; i < numDivisorLimbs; ++i)
+                {
+                    std::uint64_t sum = remainder[position + i] + divisor[i] + addCarry;
+                    addCarry = (sum >= ChunkBase) ? 1 : 0;
+                    remainder[position + i] = static_cast<std::uint32_t>(sum - (addCarry * ChunkBase));
+                }
+
+                // Wraps back around to zero
+                remainder[position + numDivisorLimbs] = static_cast<std::uint32_t>(remainder[position + numDivisorLimbs] + addCarry);
+            }
+
+            quotient[position] = static_cast<std::uint32_t>(estimate);
         }
 
-        ++firstIter;
-        ++secondIter;
+        remainder.resize(numDivisorLimbs);
+        divideLimbs(remainder, scale);
+    }
+
+    quotientDigits = limbsToDigits(quotient);
+    remainderDigits = limbsToDigits(remainder);
+
+    if (quotientDigits.empty())
+    {
+        quotientDigits.push_back('0');
+    }
+}
+
+// Truncated towards zero, e.g. -1.5 gives -1 and -0.5 gives 0
+BigNum BigNum::integerPart() const
+{
+    BigNum integer;
+    integer.digits = integerDigits();
+    integer.hasNegativeSign = hasNegativeSign && !integer.digits.empty();
+
+    if (integer.digits.empty())
+    {
+        integer.digits.push_back('0');
+    }
+
+    return integer;
+}
+
+std::vector<char> BigNum::integerDigits() const
+{
+    std::vector<char> result(digits.begin() + decimalPosition, digits.end());
+    removeLeadingZeroDigits(result);
+
+    return result;
+}
+
+// True for the digits of 10^k, which have no leading zeroes
+static bool isPowerOf10Digits(const std::vector<char>& digits)
+{
+    return (digits.back() == '1') && std::all_of(digits.begin(), digits.end() - 1, [](char digit) { return digit == '0'; });
+}
+
+std::pair<BigNum, BigNum> BigNum::divMod(const BigNum& dividend, const BigNum& divisor)
+{
+    assert(dividend.isInteger() && divisor.isInteger());
+
+    std::vector<char> divisorDigits = divisor.integerDigits();
+
+    if (divisorDigits.empty())
+    {
+        assert(false);
+        return { BigNum::Zero, BigNum::Zero };
+    }
+
+    std::vector<char> dividendDigits = dividend.integerDigits();
+
+    BigNum quotient;
+    std::vector<char> remainderDigits;
+
+    if (isPowerOf10Digits(divisorDigits))
+    {
+        // The low digits of the dividend are the remainder and the rest the quotient
+        size_t split = std::min(divisorDigits.size() - 1, dividendDigits.size());
+
+        quotient.digits = (split < dividendDigits.size()) ? std::vector<char>(dividendDigits.begin() + split, dividendDigits.end()) : std::vector<char>{ '0' };
+
+        remainderDigits.assign(dividendDigits.begin(), dividendDigits.begin() + split);
+        removeLeadingZeroDigits(remainderDigits);
+    }
+    else if (dividendDigits.size() < divisorDigits.size())
+    {
+        quotient.digits = std::vector<char>{ '0' };
+        remainderDigits = std::move(dividendDigits);
+    }
+    else
+    {
+        std::vector<char> quotientDigits;
+        longDivideDigits(dividendDigits, divisorDigits, quotientDigits, remainderDigits);
+
+        quotient.digits = std::move(quotientDigits);
+    }
+
+    quotient.normalizeIfPadded();
+    quotient.hasNegativeSign = haveDifferentSigns(dividend, divisor) && !quotient.isZero();
+
+    BigNum remainder;
+    remainder.digits = remainderDigits.empty() ? std::vector<char>{ '0' } : std::move(remainderDigits);
+    remainder.hasNegativeSign = dividend.isNegative() && !remainder.isZero();
+
+    return { quotient, remainder };
+}
+
+BigNum operator%(const BigNum& a, const BigNum& b)
+{
+    return BigNum::divMod(a, b).second;
+}
+
+void operator%=(BigNum& a, const BigNum& b)
+{
+    a = a % b;
+}
+
+BigNum BigNum::bitwise(const BigNum& a, const BigNum& b, std::uint32_t (*operation)(std::uint32_t, std::uint32_t))
+{
+    if (!a.isInteger() || !b.isInteger())
+    {
+        return bitwise(a.integerPart(), b.integerPart(), operation);
+    }
+
+    std::vector<std::uint32_t> aWords = a.integerWords();
+    std::vector<std::uint32_t> bWords = b.integerWords();
+
+    size_t numWords = std::max(aWords.size(), bWords.size()) + 1;
+
+    makeTwosComplement(aWords, a.isNegative(), numWords);
+    makeTwosComplement(bWords, b.isNegative(), numWords);
+
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        aWords[i] = operation(aWords[i], bWords[i]);
     }
 
-    return false;
+    return fromTwosComplementWords(std::move(aWords));
+}
+
+BigNum operator&(const BigNum& a, const BigNum& b)
+{
+    return BigNum::bitwise(a, b, [](std::uint32_t x, std::uint32_t y) -> std::uint32_t { return x & y; });
+}
+
+void operator&=(BigNum& a, const BigNum& b)
+{
+    a = a & b;
+}
+
+BigNum operator|(const BigNum& a, const BigNum& b)
+{
+    return BigNum::bitwise(a, b, [](std::uint32_t x, std::uint32_t y) -> std::uint32_t { return x | y; });
+}
+
+void operator|=(BigNum& a, const BigNum& b)
+{
+    a = a | b;
+}
+
+BigNum operator^(const BigNum& a, const BigNum& b)
+{
+    return BigNum::bitwise(a, b, [](std::uint32_t x, std::uint32_t y) -> std::uint32_t { return x ^ y; });
+}
+
+void operator^=(BigNum& a, const BigNum& b)
+{
+    a = a ^ b;
 }
 
-bool operator>=(const BigNum& a, const BigNum& b)
+BigNum operator~(const BigNum& n)
 {
-    return ((a > b) || (a == b));
+    // ~n == -n - 1 in two's complement
+    return (-(n.integerPart()) - BigNum(1u));
 }
 
-BigNum operator+(const BigNum& a, const BigNum& b)
+BigNum operator<<(const BigNum& n, size_t numBits)
 {
-    if (a.isNegative() && b.isPositive())
+    if (!n.isInteger())
     {
-        return (b - -(a));
+        return n.integerPart() << numBits;
     }
 
-    if (a.isPositive() && b.isNegative())
+    std::vector<std::uint32_t> words = n.integerWords();
+
+    size_t wordShift = numBits / 32;
+    size_t bitShift = numBits % 32;
+
+    std::vector<std::uint32_t> shifted(words.size() + wordShift + 1, 0);
+
+    for (size_t i = 0; i < words.size(); ++i)
     {
-        return (a - -(b));
+        std::uint64_t widened = static_cast<std::uint64_t>(words[i]) << bitShift;
+
+        shifted[i + wordShift] |= static_cast<std::uint32_t>(widened);
+        shifted[i + wordShift + 1] |= static_cast<std::uint32_t>(widened >> 32);
     }
 
-    if (a.isNegative() && b.isNegative())
+    return BigNum::fromIntegerWords(shifted, n.isNegative());
+}
+
+void operator<<=(BigNum& n, size_t numBits)
+{
+    n = n << numBits;
+}
+
+BigNum operator>>(const BigNum& n, size_t numBits)
+{
+    if (!n.isInteger())
     {
-        return -(-(a) + -(b));
+        return n.integerPart() >> numBits;
     }
 
-    std::pair<BigNum, BigNum> decimalsLinedUp = makeWithLinedUpDecimalPositions(a, b);
+    std::vector<std::uint32_t> words = n.integerWords();
 
-    size_t maxDigits = std::max(decimalsLinedUp.first.numDigits(), decimalsLinedUp.second.numDigits());
+    size_t wordShift = numBits / 32;
+    size_t bitShift = numBits % 32;
 
-    std::list<std::vector<char>> carries;
-
-    BigNum result;
+    // A negative number is shifted arithmetically, i.e. it rounds towards negative infinity
+    bool roundMagnitudeUp = false;
 
-    size_t i = 0;
-    while ((i < maxDigits) || !carries.empty())
+    if (n.isNegative())
     {
-        unsigned int currentSum = 0;
-
-        if (!carries.empty())
+        for (size_t i = 0; (i < wordShift) && (i < words.size()); ++i)
         {
-            for (char c : carries.front())
-            {
-                currentSum += digitToUint(c);
-            }
-
-            carries.pop_front();
+            roundMagnitudeUp = roundMagnitudeUp || (words[i] != 0);
         }
 
-        currentSum += decimalsLinedUp.first.digitAt(i);
-        currentSum += decimalsLinedUp.second.digitAt(i);
-
-        std::vector<char> chars = uintToChars(currentSum);
+        if ((wordShift < words.size()) && (bitShift != 0))
+        {
+            roundMagnitudeUp = roundMagnitudeUp || ((words[wordShift] & ((std::uint32_t(1) << bitShift) - 1)) != 0);
+        }
+    }
 
-        result.digits.push_back(chars[0]);
+    std::vector<std::uint32_t> shifted;
 
-        auto carriesIter = carries.begin();
+    if (wordShift < words.size())
+    {
+        shifted.resize(words.size() - wordShift, 0);
 
-        for (size_t currentSumCharIndex = 1; currentSumCharIndex < chars.size(); ++currentSumCharIndex)
+        for (size_t i = 0; i < shifted.size(); ++i)
         {
-            if (carriesIter == carries.end())
+            std::uint64_t widened = words[i + wordShift];
+
+            if ((i + wordShift + 1) < words.size())
             {
-                carries.push_front({});
-                carriesIter = carries.begin();
+                widened |= static_cast<std::uint64_t>(words[i + wordShift + 1]) << 32;
             }
 
-            carriesIter->push_back(chars[currentSumCharIndex]);
-            ++carriesIter;
+            shifted[i] = static_cast<std::uint32_t>(widened >> bitShift);
         }
-
-        ++i;
     }
 
-    result.decimalPosition = decimalsLinedUp.first.numDigitsAfterDecimal();
+    BigNum result = BigNum::fromIntegerWords(shifted, n.isNegative());
+
+    if (roundMagnitudeUp)
+    {
+        result -= BigNum(1u);
+    }
 
     return result;
 }
 
-void operator+=(BigNum& a, const BigNum& b)
+void operator>>=(BigNum& n, size_t numBits)
 {
-    a = a + b;
+    n = n >> numBits;
 }
 
-BigNum operator-(const BigNum& num)
+BigNum abs(const BigNum& n)
 {
-    BigNum negated = num;
-    negated.hasNegativeSign = !negated.hasNegativeSign;
+    BigNum result = n;
+    result.hasNegativeSign = false;
 
-    return negated;
+    return result;
 }
 
-BigNum operator-(const BigNum& a, const BigNum& b)
+static void removeLeadingZeroWords(std::vector<std::uint32_t>& words)
 {
-    if (a.isNegative() && b.isPositive())
+    while (!words.empty() && (words.back() == 0))
     {
-        return -(-(a) + b);
+        words.pop_back();
     }
+}
 
-    if (a.isPositive() && b.isNegative())
+// Compares words without leading zeroes
+static int compareWords(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b)
+{
+    if (a.size() != b.size())
     {
-        return (a + -(b));
+        return (a.size() < b.size()) ? -1 : 1;
     }
 
-    if (a.isNegative() && b.isNegative())
+    for (size_t i = a.size(); i > 0; --i)
     {
-        return (-(b) - -(a));
+        if (a[i - 1] != b[i - 1])
+        {
+            return (a[i - 1] < b[i - 1]) ? -1 : 1;
+        }
     }
 
-    if (b > a)
+    return 0;
+}
+
+// a -= b where a >= b
+static void subtractWords(std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b)
+{
+    std::uint64_t borrow = 0;
+    for (size_t i = 0; (i < a.size()) && ((i < b.size()) || (borrow != 0)); ++i)
     {
-        return -(b - a);
+        std::uint64_t subtrahend = ((i < b.size()) ? b[i] : 0) + borrow;
+
+        borrow = (a[i] < subtrahend) ? 1 : 0;
+        a[i] = static_cast<std::uint32_t>((a[i] + (borrow << 32)) - subtrahend);
     }
 
-    BigNum result;
+    assert(borrow == 0);
 
-    std::pair<BigNum, BigNum> decimalsLinedUp = makeWithLinedUpDecimalPositions(a, b);
+    removeLeadingZeroWords(a);
+}
 
-    size_t maxDigits = std::max(decimalsLinedUp.first.numDigits(), decimalsLinedUp.second.numDigits());
-    for (size_t i = 0; i < maxDigits; ++i)
+// The words must not be zero
+static size_t numTrailingZeroBits(const std::vector<std::uint32_t>& words)
+{
+    size_t bit = 0;
+    while (!wordBit(words, bit))
     {
-        unsigned int currentDifference = decimalsLinedUp.first.digitAt(i);
+        ++bit;
+    }
 
-        if (decimalsLinedUp.first.digitAt(i) < decimalsLinedUp.second.digitAt(i))
-        {
-            currentDifference += 10;
+    return bit;
+}
 
-            size_t borrowIndex = i + 1;
+static void shiftWordsRight(std::vector<std::uint32_t>& words, size_t numBits)
+{
+    size_t wordShift = std::min(numBits / 32, words.size());
+    size_t bitShift = numBits % 32;
 
-            while (decimalsLinedUp.first.digitAt(borrowIndex) == 0)
-            {
-                decimalsLinedUp.first.digits[borrowIndex] = '9';
-                ++borrowIndex;
-            }
+    words.erase(words.begin(), words.begin() + wordShift);
 
-            decimalsLinedUp.first.digits[borrowIndex] -= static_cast<char>(1);
+    if (bitShift != 0)
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            std::uint32_t high = ((i + 1) < words.size()) ? words[i + 1] : 0;
+            words[i] = (words[i] >> bitShift) | (high << (32 - bitShift));
         }
+    }
+
+    removeLeadingZeroWords(words);
+}
 
-        currentDifference -= decimalsLinedUp.second.digitAt(i);
+// Binary GCD, which needs only subtractions and shifts of the base 2^32 words. The
+// common factors of 2 are set aside, then the larger of the two odd numbers is
+// replaced by their difference with its factors of 2 shifted out until they meet.
+BigNum gcd(const BigNum& a, const BigNum& b)
+{
+    std::vector<std::uint32_t> x = a.integerWords();
+    std::vector<std::uint32_t> y = b.integerWords();
 
-        std::vector<char> chars = uintToChars(currentDifference);
-        assert(chars.size() == 1);
+    removeLeadingZeroWords(x);
+    removeLeadingZeroWords(y);
 
-        result.digits.push_back(chars[0]);
+    if (x.empty() || y.empty())
+    {
+        return BigNum::fromIntegerWords(x.empty() ? y : x, false);
     }
 
-    result.decimalPosition = decimalsLinedUp.first.numDigitsAfterDecimal();
+    size_t xShift = numTrailingZeroBits(x);
+    size_t yShift = numTrailingZeroBits(y);
 
-    return result.removeLeadingZeroes();
-}
+    shiftWordsRight(x, xShift);
+    shiftWordsRight(y, yShift);
 
-void operator-=(BigNum& a, const BigNum& b)
-{
-    a = a - b;
+    for (int comparison = compareWords(x, y); comparison != 0; comparison = compareWords(x, y))
+    {
+        if (comparison < 0)
+        {
+            std::swap(x, y);
+        }
+
+        subtractWords(x, y);
+        shiftWordsRight(x, numTrailingZeroBits(x));
+    }
+
+    return BigNum::fromIntegerWords(x, false) << std::min(xShift, yShift);
 }
 
-static bool haveDifferentSigns(const BigNum& a, const BigNum& b)
+BigNum lcm(const BigNum& a, const BigNum& b)
 {
-    return ((a.isNegative() && !b.isNegative()) || (!a.isNegative() && b.isNegative()));
+    if ((abs(a) == BigNum::Zero) || (abs(b) == BigNum::Zero))
+    {
+        return BigNum::Zero;
+    }
+
+    return (BigNum::divMod(abs(a), gcd(a, b)).first * abs(b));
 }
 
-BigNum multLessThan10(const BigNum& lessThan10, const BigNum& n)
+BigNum extendedGcd(const BigNum& a, const BigNum& b, BigNum& x, BigNum& y)
 {
-    BigNum result = BigNum::Zero;
+    BigNum previousRemainder = a;
+    BigNum remainder = b;
 
-    BigNum absN = abs(n);
+    BigNum previousX(1);
+    BigNum currentX(0);
 
-    unsigned int absLessThan10AsNum = lessThan10.digitAt(0);
+    BigNum previousY(0);
+    BigNum currentY(1);
 
-    for (unsigned int i = 0; i < absLessThan10AsNum; ++i)
+    while (abs(remainder) != BigNum::Zero)
     {
-        result += absN;
+        BigNum quotient = BigNum::divMod(previousRemainder, remainder).first;
+
+        BigNum nextRemainder = previousRemainder - (quotient * remainder);
+        previousRemainder = std::move(remainder);
+        remainder = std::move(nextRemainder);
+
+        BigNum nextX = previousX - (quotient * currentX);
+        previousX = std::move(currentX);
+        currentX = std::move(nextX);
+
+        BigNum nextY = previousY - (quotient * currentY);
+        previousY = std::move(currentY);
+        currentY = std::move(nextY);
     }
 
-    if (haveDifferentSigns(lessThan10, n))
+    if (previousRemainder.isNegative())
     {
-        return -result;
+        previousRemainder = -previousRemainder;
+        previousX = -previousX;
+        previousY = -previousY;
     }
 
-    return result;
+    x = previousX;
+    y = previousY;
+
+    return previousRemainder;
 }
 
-BigNum operator*(const BigNum& a, const BigNum& b)
+static BigNum nonNegativeMod(const BigNum& n, const BigNum& modulus)
 {
-    BigNum result = BigNum::Zero;
+    BigNum result = n % modulus;
 
-    std::pair<BigNum, BigNum> decimalsLinedUp = makeWithLinedUpDecimalPositions(a, b);
+    if (result.isNegative())
+    {
+        result += modulus;
+    }
+
+    return result;
+}
 
-    size_t numAfterDecimal = decimalsLinedUp.first.numDigitsAfterDecimal();
+BigNum modInverse(const BigNum& a, const BigNum& modulus)
+{
+    assert(modulus > BigNum::Zero);
 
-    std::pair<BigNum, BigNum> withoutDecimals = { decimalsLinedUp.first.multPower10(numAfterDecimal), decimalsLinedUp.second.multPower10(numAfterDecimal) };
+    BigNum x(0);
+    BigNum y(0);
 
-    for (size_t i = 0; i < withoutDecimals.first.numDigits(); ++i)
+    if (extendedGcd(nonNegativeMod(a, modulus), modulus, x, y) != BigNum(1))
     {
-        BigNum aDigit(withoutDecimals.first.digitAt(i));
-        aDigit.hasNegativeSign = withoutDecimals.first.hasNegativeSign;
-
-        result += multLessThan10(aDigit, withoutDecimals.second).multPower10(i);
+        assert(false);
+        return BigNum::Zero;
     }
 
-    return result.dividePower10(2 * numAfterDecimal).removeTrailingZeroes();
+    return nonNegativeMod(x, modulus);
 }
 
-void operator*=(BigNum& a, const BigNum& b)
+BigNum powMod(const BigNum& base, const BigNum& exponent, const BigNum& modulus)
 {
-    a = a * b;
+    assert(modulus > BigNum::Zero);
+    assert(!exponent.isNegative());
+
+    BigNum result = nonNegativeMod(BigNum(1), modulus);
+    BigNum reducedBase = nonNegativeMod(base, modulus);
+
+    for (unsigned char byte : exponent.toBytes())
+    {
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            result = (result * result) % modulus;
+
+            if (((byte >> bit) & 1) != 0)
+            {
+                result = (result * reducedBase) % modulus;
+            }
+        }
+    }
+
+    return result;
 }
 
-static BigNum integerDivide(const BigNum& dividend, const BigNum& divisor)
+BigNum pow(const BigNum& base, size_t exponent)
 {
-    BigNum result = BigNum::Zero;
+    size_t numBits = 0;
+    while ((numBits < (8 * sizeof(size_t))) && ((exponent >> numBits) != 0))
+    {
+        ++numBits;
+    }
 
-    BigNum remainder = dividend;
+    ProgressScope progress(numBits);
 
-    while (remainder >= divisor)
+    BigNum result(1);
+
+    for (size_t bit = numBits; bit > 0; --bit)
     {
-        remainder -= divisor;
-        result += BigNum("1");
+        progress.report(numBits - bit);
+
+        result = result * result;
+
+        if (((exponent >> (bit - 1)) & 1) != 0)
+        {
+            result = result * base;
+        }
     }
 
     return result;
 }
 
-BigNum operator/(const BigNum& a, const BigNum& b)
+BigNum sqrt(const BigNum& n, size_t maxDigitsAfterDecimal)
 {
-    if (abs(b) == BigNum::Zero)
+    if (n.isNegative())
     {
         assert(false);
         return BigNum::Zero;
     }
 
-    size_t maxDecimals = std::max(a.numDigitsAfterDecimal(), b.numDigitsAfterDecimal());
+    // floor(sqrt(n * 10^2p)) / 10^p. Newton's method on integers, started above the root,
+    // decreases monotonically until it reaches the integer square root.
+    BigNum scaled = BigNum::divide(n.multPower10(2 * maxDigitsAfterDecimal), BigNum(1), 0);
+
+    if (scaled == BigNum::Zero)
+    {
+        return BigNum::Zero;
+    }
+
+    BigNum root = BigNum::powerOf10((scaled.numDigitsBeforeDecimal() + 1) / 2);
+
+    // The starting point is within a factor of 10 of the root, after which every
+    // iteration roughly doubles the number of correct digits
+    size_t expectedIterations = 5;
+    for (size_t numDigits = 1; numDigits < root.numDigits(); numDigits *= 2)
+    {
+        ++expectedIterations;
+    }
+
+    ProgressScope progress(expectedIterations);
+
+    for (size_t iteration = 0; ; ++iteration)
+    {
+        progress.report(iteration);
+
+        BigNum next = BigNum::divMod(root + BigNum::divMod(scaled, root).first, BigNum(2)).first;
+
+        if (next >= root)
+        {
+            break;
+        }
+
+        root = next;
+    }
+
+    return root.dividePower10(maxDigitsAfterDecimal);
+}
+
+static bool isStrongProbablePrime(const BigNum& n, const BigNum& nMinus1, const BigNum& oddPart, unsigned int powerOf2, const BigNum& witness)
+{
+    BigNum x = powMod(witness, oddPart, n);
+
+    if ((x == BigNum(1)) || (x == nMinus1))
+    {
+        return true;
+    }
+
+    for (unsigned int i = 1; i < powerOf2; ++i)
+    {
+        x = (x * x) % n;
+
+        if (x == nMinus1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
 
-    BigNum dividend = abs(a.multPower10(maxDecimals));
-    BigNum divisor = abs(b.multPower10(maxDecimals));
+// Jacobi symbol (a/n) for odd n > 0 and a != 0 small enough for a native integer
+static int jacobiSymbol(long long a, const BigNum& n)
+{
+    int result = 1;
 
-    std::vector<char> resultString;
+    unsigned int nMod8 = BigNum::divMod(n, BigNum(8)).second.to<unsigned int>();
 
-    if (haveDifferentSigns(a, b))
+    if (a < 0)
     {
-        resultString.push_back('-');
+        a = -a;
+        result = ((nMod8 % 4) == 3) ? -result : result;
     }
 
-    resultString.push_back('0');
+    unsigned long long x = static_cast<unsigned long long>(a);
 
-    size_t digitIndex = dividend.numDigits() - 1;
-    BigNum integerDividend = BigNum(dividend.digitAt(digitIndex));
+    while ((x % 2) == 0)
+    {
+        x /= 2;
+        result = ((nMod8 == 3) || (nMod8 == 5)) ? -result : result;
+    }
 
-    int digitsAfterDecimal = -1;
+    // Quadratic reciprocity turns (x/n) into (n mod x / x), which is small from then on
+    result = (((x % 4) == 3) && ((nMod8 % 4) == 3)) ? -result : result;
 
-    while (integerDividend != BigNum::Zero)
+    unsigned long long y = x;
+    x = BigNum::divMod(n, BigNum(y)).second.to<unsigned long long>();
+
+    while (x != 0)
     {
-        BigNum singleDigitResult = integerDivide(integerDividend, divisor);
-        assert(singleDigitResult.numDigits() == 1);
+        while ((x % 2) == 0)
+        {
+            x /= 2;
+            result = (((y % 8) == 3) || ((y % 8) == 5)) ? -result : result;
+        }
+
+        std::swap(x, y);
+        result = (((x % 4) == 3) && ((y % 4) == 3)) ? -result : result;
+        x %= y;
+    }
+
+    return (y == 1) ? result : 0;
+}
+
+// Strong Lucas test with Selfridge's parameters: D is the first of 5, -7, 9, -11, ...
+// with (D/n) == -1, P == 1 and Q == (1 - D) / 4. n must be odd and above 97^2.
+static bool isStrongLucasProbablePrime(const BigNum& n)
+{
+    long long d = 5;
 
-        resultString.push_back(singleDigitResult.digits[0]);
+    for (unsigned int attempt = 1; ; ++attempt)
+    {
+        int jacobi = jacobiSymbol(d, n);
 
-        integerDividend -= singleDigitResult * divisor;
+        if (jacobi == -1)
+        {
+            break;
+        }
 
-        integerDividend = integerDividend.multPower10(1);
+        if ((jacobi == 0) && (BigNum(d < 0 ? -d : d) != n))
+        {
+            return false;
+        }
 
-        if (digitIndex == 0)
+        // No D works for a perfect square, which is only worth ruling out once the search takes long
+        if (attempt == 20)
         {
-            ++digitsAfterDecimal;
-            if (digitsAfterDecimal == BigNum::MaxDigitsAfterDecimal)
+            BigNum root = sqrt(n, 0);
+            if ((root * root) == n)
             {
-                break;
+                return false;
             }
         }
-        else
+
+        d = (d > 0) ? -(d + 2) : (-d + 2);
+    }
+
+    BigNum dModN = nonNegativeMod(BigNum(d), n);
+    BigNum q = nonNegativeMod(BigNum((1 - d) / 4), n);
+
+    // n + 1 == oddPart * 2^powerOf2
+    BigNum oddPart = n + BigNum(1);
+    unsigned int powerOf2 = 0;
+
+    while ((oddPart % BigNum(2)) == BigNum::Zero)
+    {
+        oddPart = BigNum::divMod(oddPart, BigNum(2)).first;
+        ++powerOf2;
+    }
+
+    // x / 2 mod n, which is odd
+    auto halve = [&n](const BigNum& x)
+    {
+        return BigNum::divMod(((x % BigNum(2)) == BigNum::Zero) ? x : (x + n), BigNum(2)).first % n;
+    };
+
+    // U_k, V_k and Q^k mod n, with k built up from the bits of oddPart, most significant first
+    BigNum u(0);
+    BigNum v(2);
+    BigNum qToK(1);
+
+    for (unsigned char byte : oddPart.toBytes())
+    {
+        for (int bit = 7; bit >= 0; --bit)
         {
-            --digitIndex;
-            integerDividend += BigNum(dividend.digitAt(digitIndex));
+            u = (u * v) % n;
+            v = nonNegativeMod((v * v) - (BigNum(2) * qToK), n);
+            qToK = (qToK * qToK) % n;
+
+            if (((byte >> bit) & 1) != 0)
+            {
+                BigNum nextU = halve(u + v);
+                v = halve(((dModN * u) % n) + v);
+                u = std::move(nextU);
+                qToK = (qToK * q) % n;
+            }
         }
     }
 
-    if (digitsAfterDecimal > 0)
+    if ((u == BigNum::Zero) || (v == BigNum::Zero))
     {
-        size_t negativeSignOffset = (resultString[0] == '-') ? 1 : 0;
-        resultString.insert(resultString.begin() + dividend.numDigits() + 1 + negativeSignOffset, '.');
+        return true;
     }
 
-    resultString.push_back('\0');
+    for (unsigned int i = 1; i < powerOf2; ++i)
+    {
+        v = nonNegativeMod((v * v) - (BigNum(2) * qToK), n);
+
+        if (v == BigNum::Zero)
+        {
+            return true;
+        }
+
+        qToK = (qToK * qToK) % n;
+    }
 
-    return BigNum(resultString.data());
+    return false;
 }
 
-void operator/=(BigNum& a, const BigNum& b)
+bool isProbablePrime(const BigNum& n, unsigned int numRounds)
 {
-    a = a / b;
+    static const unsigned int smallPrimes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97 };
+    static const size_t numSmallPrimes = sizeof(smallPrimes) / sizeof(smallPrimes[0]);
+
+    if (!n.isInteger() || (n < BigNum(2)))
+    {
+        return false;
+    }
+
+    for (unsigned int prime : smallPrimes)
+    {
+        if (n == BigNum(prime))
+        {
+            return true;
+        }
+
+        if ((n % BigNum(prime)) == BigNum::Zero)
+        {
+            return false;
+        }
+    }
+
+    // Every composite below 97^2 has a factor among the small primes
+    if (n < BigNum(97 * 97))
+    {
+        return true;
+    }
+
+    // n - 1 == oddPart * 2^powerOf2
+    BigNum nMinus1 = n - BigNum(1);
+    BigNum oddPart = nMinus1;
+    unsigned int powerOf2 = 0;
+
+    while ((oddPart % BigNum(2)) == BigNum::Zero)
+    {
+        oddPart = BigNum::divMod(oddPart, BigNum(2)).first;
+        ++powerOf2;
+    }
+
+    // Baillie-PSW, no composite is known to pass both of these
+    if (!isStrongProbablePrime(n, nMinus1, oddPart, powerOf2, BigNum(2)) || !isStrongLucasProbablePrime(n))
+    {
+        return false;
+    }
+
+    for (size_t i = 1; (i < numRounds) && (i < numSmallPrimes); ++i)
+    {
+        if (!isStrongProbablePrime(n, nMinus1, oddPart, powerOf2, BigNum(smallPrimes[i])))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
-BigNum abs(const BigNum& n)
+std::ostream& operator<<(std::ostream& out, const BigNum& n)
 {
-    BigNum result = n;
-    result.hasNegativeSign = false;
-
-    return result;
+    n.display(out);
+    return out;
 }
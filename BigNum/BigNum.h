@@ -3,6 +3,14 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <functional>
+#include <iosfwd>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+#include <cassert>
 
 class BigNum
 {
@@ -22,44 +30,258 @@ friend BigNum operator*(const BigNum& a, const BigNum& b);
 friend void operator*=(BigNum& a, const BigNum& b);
 friend BigNum operator/(const BigNum& a, const BigNum& b);
 friend void operator/=(BigNum& a, const BigNum& b);
+friend BigNum operator%(const BigNum& a, const BigNum& b);
+friend void operator%=(BigNum& a, const BigNum& b);
+
+friend BigNum operator&(const BigNum& a, const BigNum& b);
+friend void operator&=(BigNum& a, const BigNum& b);
+friend BigNum operator|(const BigNum& a, const BigNum& b);
+friend void operator|=(BigNum& a, const BigNum& b);
+friend BigNum operator^(const BigNum& a, const BigNum& b);
+friend void operator^=(BigNum& a, const BigNum& b);
+friend BigNum operator~(const BigNum& n);
+friend BigNum operator<<(const BigNum& n, size_t numBits);
+friend void operator<<=(BigNum& n, size_t numBits);
+friend BigNum operator>>(const BigNum& n, size_t numBits);
+friend void operator>>=(BigNum& n, size_t numBits);
 
 friend BigNum abs(const BigNum& n);
+friend BigNum gcd(const BigNum& a, const BigNum& b);
 
 public:
+    struct DisplayFormat
+    {
+        char groupSeparator = '\0'; // '\0' means no grouping of the digits before the decimal
+        size_t groupSize = 3;
+        bool scientific = false;
+    };
+
+    using DisplaySink = std::function<void(const char* chars, size_t numChars)>;
+
+    enum class ExecutionPolicy
+    {
+        Sequential,
+        Parallel
+    };
+
     explicit BigNum(std::string s);
+    explicit BigNum(int n);
     explicit BigNum(unsigned int n);
+    explicit BigNum(long n);
+    explicit BigNum(unsigned long n);
+    explicit BigNum(long long n);
+    explicit BigNum(unsigned long long n);
+#ifdef __SIZEOF_INT128__
+    explicit BigNum(__int128 n);
+    explicit BigNum(unsigned __int128 n);
+#endif
+    explicit BigNum(double n); // exact, every finite double is a terminating decimal
+    explicit BigNum(long double n); // exact
+
+    // Long running operations (products, quotients, powers, roots, display and conversions to binary)
+    // report to the observer installed on the calling thread, which may throw from
+    // checkpoint() to abandon the operation. Used by BigNumAsync.
+    class ProgressObserver
+    {
+    public:
+        virtual ~ProgressObserver() = default;
+
+        virtual void checkpoint() = 0;
+        virtual void onProgress(size_t done, size_t total) = 0;
+    };
+
+    static ProgressObserver* setProgressObserver(ProgressObserver* observer); // returns the calling thread's previous observer
 
     static const BigNum Zero;
     static const int MaxDigitsAfterDecimal = 1000;
+    static const size_t DisplayChunkSize = 4096;
+
+    // 10^power10 and 10^-power10. Powers up to PowerOf10CacheSize are built once, on first
+    // use from any thread, and then shared by every caller without copying their digits.
+    static const size_t PowerOf10CacheSize = 1024;
+    static BigNum powerOf10(size_t power10);
+    static BigNum reciprocalPowerOf10(size_t power10);
 
     static BigNum makeWithAdditionalTrailingZeroes(const BigNum& n, size_t numAdditionalTrailingZeroes);
 
+    // Division truncated towards zero after maxDigitsAfterDecimal digits, operator/ keeps MaxDigitsAfterDecimal
+    static BigNum divide(const BigNum& a, const BigNum& b, size_t maxDigitsAfterDecimal);
+
+    // Exact sum of [begin, end), which must dereference to BigNum. The parallel policy
+    // splits the range into one shard per hardware thread and adds the shard sums as a tree.
+    template <typename Iterator>
+    static BigNum sum(Iterator begin, Iterator end, ExecutionPolicy policy = ExecutionPolicy::Sequential);
+
+    // Integer division that truncates towards zero, so the remainder has the sign of the dividend.
+    // A divisor that is a power of 10 just splits the dividend's digits.
+    static std::pair<BigNum, BigNum> divMod(const BigNum& dividend, const BigNum& divisor);
+
     bool isPositive() const;
     bool isNegative() const;
+    bool isInteger() const;
+
+    // Results of arithmetic may be stored with up to PaddingThreshold zeroes before the units
+    // digit or after the last significant decimal. The digit accessors look past them, so
+    // 1.25 + 0.75 has no digits after the decimal.
+    static const size_t PaddingThreshold = 64;
+
     size_t numDigits() const;
     size_t numDigitsBeforeDecimal() const;
     size_t numDigitsAfterDecimal() const;
     size_t getDecimalPosition() const;
     unsigned int digitAt(size_t i) const;
 
+    // Agrees with operator==, e.g. 1.50 and 1.5 hash the same. Computed once and then cached.
+    size_t hash() const;
+
     std::string display() const;
+    std::string display(const DisplayFormat& format) const;
+
+    // Streams the digits, most significant first, in chunks of at most DisplayChunkSize chars
+    void display(std::ostream& out) const;
+    void display(std::ostream& out, const DisplayFormat& format) const;
+    void display(const DisplaySink& sink) const;
+    void display(const DisplaySink& sink, const DisplayFormat& format) const;
+
+    double toDouble() const; // rounded to nearest, ties to even
+
+    template <typename Integer>
+    bool fitsIn() const; // true if the number is an integer that Integer can represent exactly
+
+    template <typename Integer>
+    Integer to() const; // the number must fit in Integer
 
     BigNum multPower10(size_t power10) const;
     BigNum dividePower10(size_t power10) const;
 
+    // Bit operations act on the integer part, truncated towards zero, with two's complement
+    // semantics, i.e. a negative number behaves as if it had an infinite run of leading 1 bits
+    static BigNum fromBytes(const std::vector<unsigned char>& bytes); // big-endian two's complement
+    std::vector<unsigned char> toBytes() const; // big-endian two's complement, fewest bytes possible
+
+    size_t popcount() const; // number of bits that differ from the sign bit
+    size_t bitLength() const; // number of bits excluding the sign bit
+    bool testBit(size_t bit) const;
+    BigNum setBit(size_t bit) const;
+
 private:
     BigNum();
 
     void forceZero();
 
-    void removeLeadingAndTrailingZeroes();
+    static BigNum fromFloatingPoint(long double n);
+
+    template <typename Integer>
+    bool integerPartTo(Integer& value) const;
+
+    // Results of arithmetic keep their zero padding until it grows past PaddingThreshold,
+    // display and comparisons look past it, so trimming is left to normalize()
+    void normalize();
+    void normalizeIfPadded();
+
+    size_t numLeadingPaddingZeroes() const;
+    size_t numTrailingPaddingZeroes() const;
+
+    // The stored digits, including any padding
+    size_t numStoredDigits() const;
+    unsigned int storedDigitAt(size_t i) const;
+
+    static int compare(const BigNum& a, const BigNum& b);
+
+    static std::pair<BigNum, BigNum> makeWithLinedUpDecimalPositions(const BigNum& a, const BigNum& b);
+
+    std::vector<std::uint32_t> integerWords() const;
+    static BigNum fromIntegerWords(const std::vector<std::uint32_t>& words, bool negative);
+
+    static BigNum fromTwosComplementWords(std::vector<std::uint32_t> words);
+
+    BigNum integerPart() const;
+    std::vector<char> integerDigits() const;
+
+    // Iterators that dereference to values rather than to BigNum lvalues, e.g. transforming
+    // ones, have the values kept in values for as long as the addends point to them
+    template <typename Iterator>
+    static void collectAddends(Iterator begin, Iterator end, std::vector<const BigNum*>& addends, std::vector<BigNum>& values, std::true_type yieldsLvalues);
+    template <typename Iterator>
+    static void collectAddends(Iterator begin, Iterator end, std::vector<const BigNum*>& addends, std::vector<BigNum>& values, std::false_type yieldsLvalues);
+
+    static BigNum sumAddends(const std::vector<const BigNum*>& addends, ExecutionPolicy policy);
+    static BigNum sumShard(const BigNum* const* begin, const BigNum* const* end);
+
+    static BigNum bitwise(const BigNum& a, const BigNum& b, std::uint32_t (*operation)(std::uint32_t, std::uint32_t));
+
+    bool findSignificantDigits(size_t& leastSignificant, size_t& mostSignificant) const;
+    bool isZero() const; // stops at the most significant nonzero digit, so O(1) for most numbers
+
+    // Forgets the hash whenever the number is copied or assigned, so that
+    // the copy can be modified in place without leaving a stale hash behind
+    class CachedHash
+    {
+    public:
+        CachedHash() = default;
+        CachedHash(const CachedHash&) noexcept {}
+        CachedHash& operator=(const CachedHash&) noexcept { value.store(0, std::memory_order_relaxed); return *this; }
+
+        mutable std::atomic<size_t> value{ 0 }; // 0 until the hash has been computed
+    };
+
+    // Digits shared between copies until one of the copies modifies them. Reading through
+    // a const SharedDigits never copies, anything that can modify the digits first makes
+    // sure that this is the only owner. No storage means no digits, so empty digits and
+    // moved-from objects don't allocate.
+    class SharedDigits
+    {
+    public:
+        SharedDigits() = default;
+        SharedDigits(std::vector<char> digits) { *this = std::move(digits); }
+
+        SharedDigits(const SharedDigits&) = default;
+        SharedDigits(SharedDigits&&) noexcept = default;
+        SharedDigits& operator=(const SharedDigits&) = default;
+        SharedDigits& operator=(SharedDigits&&) noexcept = default;
+
+        SharedDigits& operator=(std::vector<char> digits)
+        {
+            storage = digits.empty() ? nullptr : std::make_shared<std::vector<char>>(std::move(digits));
+            return *this;
+        }
+
+        const std::vector<char>& get() const { return storage ? *storage : noDigits(); }
+        std::vector<char>& mutate();
 
-    BigNum removeLeadingZeroes() const;
-    BigNum removeTrailingZeroes() const;
+        size_t size() const { return get().size(); }
+        bool empty() const { return get().empty(); }
+        char back() const { return get().back(); }
 
-    std::vector<char> digits;
+        char operator[](size_t i) const { return get()[i]; }
+        char& operator[](size_t i) { return mutate()[i]; }
+
+        std::vector<char>::const_iterator begin() const { return get().begin(); }
+        std::vector<char>::const_iterator end() const { return get().end(); }
+        std::vector<char>::const_reverse_iterator rbegin() const { return get().rbegin(); }
+        std::vector<char>::const_reverse_iterator rend() const { return get().rend(); }
+
+        void reserve(size_t n) { mutate().reserve(n); }
+        void resize(size_t n) { mutate().resize(n); }
+        void resize(size_t n, char c) { mutate().resize(n, c); }
+        void assign(size_t n, char c) { mutate().assign(n, c); }
+        void push_back(char c) { mutate().push_back(c); }
+        void pop_back() { mutate().pop_back(); }
+
+        void insertAt(size_t i, size_t n, char c) { std::vector<char>& d = mutate(); d.insert(d.begin() + i, n, c); }
+        void eraseRange(size_t first, size_t last) { std::vector<char>& d = mutate(); d.erase(d.begin() + first, d.begin() + last); }
+
+    private:
+        static const std::vector<char>& noDigits();
+
+        std::shared_ptr<std::vector<char>> storage;
+    };
+
+    SharedDigits digits;
     bool hasNegativeSign = false;
     size_t decimalPosition = 0;
+    bool normalized = false; // known to have no padding, so the digits can be displayed as stored
+    CachedHash cachedHash;
 };
 
 bool operator<(const BigNum& a, const BigNum& b);
@@ -78,5 +300,152 @@ BigNum operator*(const BigNum& a, const BigNum& b);
 void operator*=(BigNum& a, const BigNum& b);
 BigNum operator/(const BigNum& a, const BigNum& b);
 void operator/=(BigNum& a, const BigNum& b);
+BigNum operator%(const BigNum& a, const BigNum& b);
+void operator%=(BigNum& a, const BigNum& b);
+
+BigNum operator&(const BigNum& a, const BigNum& b);
+void operator&=(BigNum& a, const BigNum& b);
+BigNum operator|(const BigNum& a, const BigNum& b);
+void operator|=(BigNum& a, const BigNum& b);
+BigNum operator^(const BigNum& a, const BigNum& b);
+void operator^=(BigNum& a, const BigNum& b);
+BigNum operator~(const BigNum& n);
+BigNum operator<<(const BigNum& n, size_t numBits);
+void operator<<=(BigNum& n, size_t numBits);
+BigNum operator>>(const BigNum& n, size_t numBits);
+void operator>>=(BigNum& n, size_t numBits);
 
 BigNum abs(const BigNum& n);
+
+// Number theory on integers
+BigNum gcd(const BigNum& a, const BigNum& b);
+BigNum lcm(const BigNum& a, const BigNum& b);
+BigNum extendedGcd(const BigNum& a, const BigNum& b, BigNum& x, BigNum& y); // a * x + b * y == gcd(a, b)
+BigNum modInverse(const BigNum& a, const BigNum& modulus); // in [0, modulus), a must be coprime to modulus
+BigNum powMod(const BigNum& base, const BigNum& exponent, const BigNum& modulus); // in [0, modulus)
+
+// Powers and roots
+BigNum pow(const BigNum& base, size_t exponent); // exact
+BigNum sqrt(const BigNum& n, size_t maxDigitsAfterDecimal); // truncated, n must not be negative
+
+// Baillie-PSW (Miller-Rabin with base 2 and a strong Lucas test), then Miller-Rabin with
+// the next primes as bases up to numRounds bases in all. No composite is known to pass,
+// and the default is proven deterministic below 3.3 * 10^24.
+bool isProbablePrime(const BigNum& n, unsigned int numRounds = 20);
+
+std::ostream& operator<<(std::ostream& out, const BigNum& n);
+
+template <typename Iterator>
+BigNum BigNum::sum(Iterator begin, Iterator end, ExecutionPolicy policy)
+{
+    using Reference = decltype(*begin);
+    using YieldsLvalues = std::integral_constant<bool, std::is_lvalue_reference<Reference>::value &&
+                                                       std::is_same<typename std::decay<Reference>::type, BigNum>::value>;
+
+    std::vector<const BigNum*> addends;
+    std::vector<BigNum> values;
+
+    collectAddends(begin, end, addends, values, YieldsLvalues());
+
+    return sumAddends(addends, policy);
+}
+
+template <typename Iterator>
+void BigNum::collectAddends(Iterator begin, Iterator end, std::vector<const BigNum*>& addends, std::vector<BigNum>&, std::true_type)
+{
+    for (; begin != end; ++begin)
+    {
+        addends.push_back(std::addressof(*begin));
+    }
+}
+
+template <typename Iterator>
+void BigNum::collectAddends(Iterator begin, Iterator end, std::vector<const BigNum*>& addends, std::vector<BigNum>& values, std::false_type)
+{
+    for (; begin != end; ++begin)
+    {
+        values.push_back(BigNum(*begin));
+    }
+
+    addends.reserve(values.size());
+
+    for (const BigNum& value : values)
+    {
+        addends.push_back(&value);
+    }
+}
+
+template <typename Integer>
+bool BigNum::fitsIn() const
+{
+    Integer value = 0;
+    return (integerPartTo(value) && isInteger());
+}
+
+template <typename Integer>
+Integer BigNum::to() const
+{
+    Integer value = 0;
+
+    if (!integerPartTo(value) || !isInteger())
+    {
+        assert(false);
+        return 0;
+    }
+
+    return value;
+}
+
+template <typename Integer>
+bool BigNum::integerPartTo(Integer& value) const
+{
+    static_assert(std::numeric_limits<Integer>::is_integer, "BigNum can only be converted to integer types");
+
+    value = 0;
+
+    for (size_t i = numStoredDigits(); i > decimalPosition; --i)
+    {
+        Integer digit = static_cast<Integer>(storedDigitAt(i - 1));
+
+        if (!isNegative())
+        {
+            if (value > ((std::numeric_limits<Integer>::max() - digit) / 10))
+            {
+                return false;
+            }
+
+            value = (value * 10) + digit;
+        }
+        else if (!std::numeric_limits<Integer>::is_signed)
+        {
+            if (digit != 0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // Accumulate negatively so that the minimum of Integer is reachable
+            if (value < ((std::numeric_limits<Integer>::min() + digit) / 10))
+            {
+                return false;
+            }
+
+            value = (value * 10) - digit;
+        }
+    }
+
+    return true;
+}
+
+namespace std
+{
+    template <>
+    struct hash<BigNum>
+    {
+        size_t operator()(const BigNum& n) const
+        {
+            return n.hash();
+        }
+    };
+}
@@ -0,0 +1,117 @@
+#include "BigNumAsync.h"
+
+CancellationToken::CancellationToken()
+    : cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+void CancellationToken::cancel()
+{
+    cancelled->store(true);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return cancelled->load();
+}
+
+namespace
+{
+    // Installed on the thread running an operation for as long as it runs
+    class TaskObserver : public BigNum::ProgressObserver
+    {
+    public:
+        explicit TaskObserver(const BigNumAsync::Options& options)
+            : options(options)
+            , previous(BigNum::setProgressObserver(this))
+        {
+        }
+
+        ~TaskObserver()
+        {
+            BigNum::setProgressObserver(previous);
+        }
+
+        void checkpoint() override
+        {
+            if (options.token.isCancelled())
+            {
+                throw OperationCancelled();
+            }
+        }
+
+        void onProgress(size_t done, size_t total) override
+        {
+            if (options.progress && (total > 0))
+            {
+                options.progress(static_cast<double>(done) / static_cast<double>(total));
+            }
+        }
+
+    private:
+        const BigNumAsync::Options& options;
+        BigNum::ProgressObserver* previous;
+    };
+}
+
+template <typename Result>
+static std::future<Result> start(std::function<Result()> operation, const BigNumAsync::Options& options)
+{
+    auto run = [operation, options]()
+    {
+        TaskObserver observer(options);
+        observer.checkpoint();
+
+        Result result = operation();
+
+        if (options.progress)
+        {
+            options.progress(1.0);
+        }
+
+        return result;
+    };
+
+    if (!options.executor)
+    {
+        return std::async(std::launch::async, run);
+    }
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(run);
+    std::future<Result> future = task->get_future();
+
+    options.executor([task]() { (*task)(); });
+
+    return future;
+}
+
+// The operands are copied into the task, which is cheap as copies share their digits
+std::future<BigNum> BigNumAsync::multiply(const BigNum& a, const BigNum& b, const Options& options)
+{
+    return start<BigNum>([a, b]() { return a * b; }, options);
+}
+
+std::future<BigNum> BigNumAsync::divide(const BigNum& a, const BigNum& b, size_t maxDigitsAfterDecimal, const Options& options)
+{
+    return start<BigNum>([a, b, maxDigitsAfterDecimal]() { return BigNum::divide(a, b, maxDigitsAfterDecimal); }, options);
+}
+
+std::future<BigNum> BigNumAsync::pow(const BigNum& base, size_t exponent, const Options& options)
+{
+    return start<BigNum>([base, exponent]() { return ::pow(base, exponent); }, options);
+}
+
+std::future<BigNum> BigNumAsync::sqrt(const BigNum& n, size_t maxDigitsAfterDecimal, const Options& options)
+{
+    return start<BigNum>([n, maxDigitsAfterDecimal]() { return ::sqrt(n, maxDigitsAfterDecimal); }, options);
+}
+
+std::future<std::string> BigNumAsync::display(const BigNum& n, const Options& options)
+{
+    return start<std::string>([n]() { return n.display(); }, options);
+}
+
+std::future<std::vector<unsigned char>> BigNumAsync::toBytes(const BigNum& n, const Options& options)
+{
+    return start<std::vector<unsigned char>>([n]() { return n.toBytes(); }, options);
+}
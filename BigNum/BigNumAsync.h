@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BigNum.h"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The future of an operation whose token was cancelled before it finished throws this from get()
+class OperationCancelled : public std::runtime_error
+{
+public:
+    OperationCancelled()
+        : std::runtime_error("BigNum operation cancelled")
+    {
+    }
+};
+
+// Copies share their state, so the caller keeps one copy and cancels every operation started with the others
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+// Runs the expensive BigNum operations off the calling thread. The operations check their
+// token between blocks of work, so cancelling stops them partway rather than at the end.
+class BigNumAsync
+{
+public:
+    using Executor = std::function<void(std::function<void()> work)>;
+    using ProgressCallback = std::function<void(double fractionDone)>; // called on the thread doing the work
+
+    struct Options
+    {
+        Executor executor; // empty runs every operation on a thread of its own, like std::async
+        CancellationToken token;
+        ProgressCallback progress;
+    };
+
+    static std::future<BigNum> multiply(const BigNum& a, const BigNum& b, const Options& options = Options());
+    static std::future<BigNum> divide(const BigNum& a, const BigNum& b, size_t maxDigitsAfterDecimal, const Options& options = Options());
+    static std::future<BigNum> pow(const BigNum& base, size_t exponent, const Options& options = Options());
+    static std::future<BigNum> sqrt(const BigNum& n, size_t maxDigitsAfterDecimal, const Options& options = Options());
+
+    static std::future<std::string> display(const BigNum& n, const Options& options = Options());
+    static std::future<std::vector<unsigned char>> toBytes(const BigNum& n, const Options& options = Options());
+};
@@ -0,0 +1,43 @@
+// libFuzzer entry point, built instead of main.cpp, e.g.
+// clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address -DBIGNUM_FUZZER BigNum.cpp DifferentialTester.cpp BigNumFuzzer.cpp
+#ifdef BIGNUM_FUZZER
+
+#include "DifferentialTester.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, size_t size)
+{
+    size_t position = 0;
+
+    // Every choice reads as few bytes as its bound needs, and zeroes once the input runs out
+    DifferentialTester tester([data, size, &position](std::uint32_t bound)
+    {
+        std::uint32_t value = 0;
+        for (int i = 0; (i < 4) && (position < size) && (((bound - 1) >> (8 * i)) != 0); ++i)
+        {
+            value = (value << 8) | data[position++];
+        }
+
+        return value;
+    });
+
+    std::string failure = tester.checkAgainstNative();
+
+    if (failure.empty())
+    {
+        failure = tester.checkIdentities();
+    }
+
+    if (!failure.empty())
+    {
+        std::fprintf(stderr, "%s\n", failure.c_str());
+        std::abort();
+    }
+
+    return 0;
+}
+
+#endif
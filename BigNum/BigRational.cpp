@@ -0,0 +1,246 @@
+#include "BigRational.h"
+
+#include <algorithm>
+#include <cassert>
+
+BigRational::BigRational(const BigNum& n)
+    : BigRational(n, BigNum(1))
+{
+}
+
+BigRational::BigRational(const BigNum& numerator, const BigNum& denominator)
+    : numerator(BigNum::Zero)
+    , denominator(1)
+{
+    if (abs(denominator) == BigNum::Zero)
+    {
+        assert(false);
+        return;
+    }
+
+    // Scale both so that they are integers
+    size_t power10 = std::max(numerator.numDigitsAfterDecimal(), denominator.numDigitsAfterDecimal());
+
+    this->numerator = numerator.multPower10(power10);
+    this->denominator = denominator.multPower10(power10);
+
+    if (this->denominator.isNegative())
+    {
+        this->numerator = -(this->numerator);
+        this->denominator = -(this->denominator);
+    }
+
+    if (abs(this->numerator) == BigNum::Zero)
+    {
+        this->numerator = BigNum::Zero;
+    }
+
+    reduceIfGrown();
+}
+
+BigRational::BigRational(BigNum numerator, BigNum denominator, size_t digitsWhenReduced)
+    : numerator(std::move(numerator))
+    , denominator(std::move(denominator))
+    , digitsWhenReduced(digitsWhenReduced)
+{
+    assert(this->denominator.isPositive());
+
+    if (abs(this->numerator) == BigNum::Zero)
+    {
+        this->numerator = BigNum::Zero;
+    }
+
+    reduceIfGrown();
+}
+
+const BigNum& BigRational::getNumerator() const
+{
+    return numerator;
+}
+
+const BigNum& BigRational::getDenominator() const
+{
+    return denominator;
+}
+
+bool BigRational::isNegative() const
+{
+    return numerator.isNegative();
+}
+
+size_t BigRational::numDigits() const
+{
+    return numerator.numDigits() + denominator.numDigits();
+}
+
+void BigRational::reduce()
+{
+    BigNum divisor = gcd(numerator, denominator);
+
+    if (divisor != BigNum(1))
+    {
+        numerator = BigNum::divMod(numerator, divisor).first;
+        denominator = BigNum::divMod(denominator, divisor).first;
+    }
+
+    digitsWhenReduced = numDigits();
+}
+
+void BigRational::reduceIfGrown()
+{
+    if (numDigits() > (digitsWhenReduced + NormalizationThreshold))
+    {
+        reduce();
+    }
+}
+
+BigRational BigRational::reduced() const
+{
+    BigRational result = *this;
+    result.reduce();
+
+    return result;
+}
+
+BigNum BigRational::toBigNum(size_t maxDigitsAfterDecimal) const
+{
+    return BigNum::divide(numerator, denominator, maxDigitsAfterDecimal);
+}
+
+std::string BigRational::display() const
+{
+    BigRational r = reduced();
+
+    if (r.denominator == BigNum(1))
+    {
+        return r.numerator.display();
+    }
+
+    return (r.numerator.display() + "/" + r.denominator.display());
+}
+
+bool operator<(const BigRational& a, const BigRational& b)
+{
+    return (b > a);
+}
+
+bool operator<=(const BigRational& a, const BigRational& b)
+{
+    return !(a > b);
+}
+
+bool operator==(const BigRational& a, const BigRational& b)
+{
+    if (a.isNegative() != b.isNegative())
+    {
+        return false;
+    }
+
+    if (a.denominator == b.denominator)
+    {
+        return (a.numerator == b.numerator);
+    }
+
+    return ((a.numerator * b.denominator) == (b.numerator * a.denominator));
+}
+
+bool operator!=(const BigRational& a, const BigRational& b)
+{
+    return !(a == b);
+}
+
+bool operator>(const BigRational& a, const BigRational& b)
+{
+    if (a.isNegative() != b.isNegative())
+    {
+        return b.isNegative();
+    }
+
+    if (a.denominator == b.denominator)
+    {
+        return (a.numerator > b.numerator);
+    }
+
+    // Denominators are positive, so cross multiplying keeps the order
+    return ((a.numerator * b.denominator) > (b.numerator * a.denominator));
+}
+
+bool operator>=(const BigRational& a, const BigRational& b)
+{
+    return !(b > a);
+}
+
+// The result of an operation is reduced once it outgrows the larger of its operands when they
+// were last reduced. Adding up the operands' sizes instead would let a fraction whose factors
+// cancel out, e.g. r * (1/D) * D, grow as fast as its threshold and never be reduced.
+size_t BigRational::digitsWhenOperandsReduced(const BigRational& a, const BigRational& b)
+{
+    return std::max(a.digitsWhenReduced, b.digitsWhenReduced);
+}
+
+BigRational operator+(const BigRational& a, const BigRational& b)
+{
+    size_t digitsWhenReduced = BigRational::digitsWhenOperandsReduced(a, b);
+
+    if (a.denominator == b.denominator)
+    {
+        return BigRational(a.numerator + b.numerator, a.denominator, digitsWhenReduced);
+    }
+
+    return BigRational((a.numerator * b.denominator) + (b.numerator * a.denominator), a.denominator * b.denominator, digitsWhenReduced);
+}
+
+void operator+=(BigRational& a, const BigRational& b)
+{
+    a = a + b;
+}
+
+BigRational operator-(const BigRational& r)
+{
+    return BigRational(-(r.numerator), r.denominator, r.digitsWhenReduced);
+}
+
+BigRational operator-(const BigRational& a, const BigRational& b)
+{
+    return (a + -(b));
+}
+
+void operator-=(BigRational& a, const BigRational& b)
+{
+    a = a - b;
+}
+
+BigRational operator*(const BigRational& a, const BigRational& b)
+{
+    return BigRational(a.numerator * b.numerator, a.denominator * b.denominator, BigRational::digitsWhenOperandsReduced(a, b));
+}
+
+void operator*=(BigRational& a, const BigRational& b)
+{
+    a = a * b;
+}
+
+BigRational operator/(const BigRational& a, const BigRational& b)
+{
+    if (b.numerator == BigNum::Zero)
+    {
+        assert(false);
+        return BigRational(BigNum::Zero);
+    }
+
+    BigNum numerator = a.numerator * b.denominator;
+    BigNum denominator = a.denominator * b.numerator;
+
+    if (denominator.isNegative())
+    {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+
+    return BigRational(numerator, denominator, BigRational::digitsWhenOperandsReduced(a, b));
+}
+
+void operator/=(BigRational& a, const BigRational& b)
+{
+    a = a / b;
+}
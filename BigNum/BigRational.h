@@ -0,0 +1,75 @@
+#pragma once
+
+#include "BigNum.h"
+
+#include <string>
+
+class BigRational
+{
+friend bool operator<(const BigRational& a, const BigRational& b);
+friend bool operator<=(const BigRational& a, const BigRational& b);
+friend bool operator==(const BigRational& a, const BigRational& b);
+friend bool operator!=(const BigRational& a, const BigRational& b);
+friend bool operator>(const BigRational& a, const BigRational& b);
+friend bool operator>=(const BigRational& a, const BigRational& b);
+
+friend BigRational operator+(const BigRational& a, const BigRational& b);
+friend void operator+=(BigRational& a, const BigRational& b);
+friend BigRational operator-(const BigRational& r);
+friend BigRational operator-(const BigRational& a, const BigRational& b);
+friend void operator-=(BigRational& a, const BigRational& b);
+friend BigRational operator*(const BigRational& a, const BigRational& b);
+friend void operator*=(BigRational& a, const BigRational& b);
+friend BigRational operator/(const BigRational& a, const BigRational& b);
+friend void operator/=(BigRational& a, const BigRational& b);
+
+public:
+    explicit BigRational(const BigNum& n);
+    BigRational(const BigNum& numerator, const BigNum& denominator);
+
+    // The fraction is only reduced once it has grown by this many digits
+    // since it was last reduced, or when it is displayed
+    static const size_t NormalizationThreshold = 64;
+
+    const BigNum& getNumerator() const;
+    const BigNum& getDenominator() const; // always positive
+
+    bool isNegative() const;
+
+    BigRational reduced() const;
+
+    BigNum toBigNum(size_t maxDigitsAfterDecimal) const; // truncated towards zero
+
+    std::string display() const; // reduced, as "numerator/denominator" or just "numerator"
+
+private:
+    BigRational(BigNum numerator, BigNum denominator, size_t digitsWhenReduced);
+
+    size_t numDigits() const;
+
+    void reduce();
+    void reduceIfGrown();
+
+    static size_t digitsWhenOperandsReduced(const BigRational& a, const BigRational& b);
+
+    BigNum numerator;
+    BigNum denominator;
+    size_t digitsWhenReduced = 0;
+};
+
+bool operator<(const BigRational& a, const BigRational& b);
+bool operator<=(const BigRational& a, const BigRational& b);
+bool operator==(const BigRational& a, const BigRational& b);
+bool operator!=(const BigRational& a, const BigRational& b);
+bool operator>(const BigRational& a, const BigRational& b);
+bool operator>=(const BigRational& a, const BigRational& b);
+
+BigRational operator+(const BigRational& a, const BigRational& b);
+void operator+=(BigRational& a, const BigRational& b);
+BigRational operator-(const BigRational& r);
+BigRational operator-(const BigRational& a, const BigRational& b);
+void operator-=(BigRational& a, const BigRational& b);
+BigRational operator*(const BigRational& a, const BigRational& b);
+void operator*=(BigRational& a, const BigRational& b);
+BigRational operator/(const BigRational& a, const BigRational& b);
+void operator/=(BigRational& a, const BigRational& b);
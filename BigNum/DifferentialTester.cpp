@@ -0,0 +1,350 @@
+#include "DifferentialTester.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Operand sizes for the native reference are chosen so that every result fits,
+// e.g. a product of two mantissas or a mantissa shifted left by MaxReferenceShift bits
+#ifdef __SIZEOF_INT128__
+using ReferenceInteger = __int128;
+using ReferenceUnsigned = unsigned __int128;
+static const size_t MaxReferenceDigits = 18;
+static const size_t MaxReferenceScale = 6;
+static const size_t MaxReferenceShift = 60;
+#else
+using ReferenceInteger = long long;
+using ReferenceUnsigned = unsigned long long;
+static const size_t MaxReferenceDigits = 9;
+static const size_t MaxReferenceScale = 3;
+static const size_t MaxReferenceShift = 30;
+#endif
+
+// mantissa / 10^scale
+struct ReferenceOperand
+{
+    ReferenceInteger mantissa;
+    size_t scale;
+};
+
+static ReferenceInteger referencePowerOf10(size_t power10)
+{
+    ReferenceInteger result = 1;
+    for (size_t i = 0; i < power10; ++i)
+    {
+        result *= 10;
+    }
+
+    return result;
+}
+
+static std::string referenceToString(const ReferenceOperand& n)
+{
+    ReferenceUnsigned magnitude = (n.mantissa < 0) ? (ReferenceUnsigned(0) - static_cast<ReferenceUnsigned>(n.mantissa)) : static_cast<ReferenceUnsigned>(n.mantissa);
+
+    std::string digits; // least significant first
+    do
+    {
+        digits.push_back(static_cast<char>('0' + static_cast<int>(magnitude % 10)));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (digits.size() <= n.scale)
+    {
+        digits.resize(n.scale + 1, '0');
+    }
+
+    size_t numTrailingZeroes = 0;
+    while ((numTrailingZeroes < n.scale) && (digits[numTrailingZeroes] == '0'))
+    {
+        ++numTrailingZeroes;
+    }
+
+    std::string result = (n.mantissa < 0) ? "-" : "";
+
+    for (size_t i = digits.size(); i > n.scale; --i)
+    {
+        result.push_back(digits[i - 1]);
+    }
+
+    if (n.scale > numTrailingZeroes)
+    {
+        result.push_back('.');
+
+        for (size_t i = n.scale; i > numTrailingZeroes; --i)
+        {
+            result.push_back(digits[i - 1]);
+        }
+    }
+
+    return result;
+}
+
+static std::string referenceToString(ReferenceInteger n)
+{
+    return referenceToString({ n, 0 });
+}
+
+// Rounds towards negative infinity, like a two's complement shift right
+static ReferenceInteger referenceFloorDivide(ReferenceInteger n, ReferenceInteger divisor)
+{
+    ReferenceInteger quotient = n / divisor;
+
+    if (((n % divisor) != 0) && ((n < 0) != (divisor < 0)))
+    {
+        --quotient;
+    }
+
+    return quotient;
+}
+
+static size_t referencePopcount(ReferenceInteger n)
+{
+    ReferenceUnsigned bits = (n < 0) ? ~static_cast<ReferenceUnsigned>(n) : static_cast<ReferenceUnsigned>(n);
+
+    size_t count = 0;
+    while (bits != 0)
+    {
+        count += static_cast<size_t>(bits & 1);
+        bits >>= 1;
+    }
+
+    return count;
+}
+
+DifferentialTester::DifferentialTester(Source source)
+    : source(std::move(source))
+{
+}
+
+std::uint32_t DifferentialTester::choose(std::uint32_t bound)
+{
+    return (bound <= 1) ? 0 : (source(bound) % bound);
+}
+
+std::string DifferentialTester::randomDigits(size_t numDigits)
+{
+    std::string digits(numDigits, '0');
+
+    for (char& digit : digits)
+    {
+        digit = static_cast<char>('0' + choose(10));
+    }
+
+    return digits;
+}
+
+BigNum DifferentialTester::randomOperand(size_t maxDigitsBeforeDecimal, size_t maxDigitsAfterDecimal)
+{
+    std::string s = choose(2) ? "-" : "";
+
+    size_t numDigitsBeforeDecimal = choose(static_cast<std::uint32_t>(maxDigitsBeforeDecimal + 1));
+    size_t numDigitsAfterDecimal = choose(static_cast<std::uint32_t>(maxDigitsAfterDecimal + 1));
+
+    // Leading and trailing zeroes are common, so that the padding and normalization paths are exercised
+    s += std::string(choose(4), '0');
+    s += randomDigits(numDigitsBeforeDecimal);
+
+    if (numDigitsAfterDecimal > 0)
+    {
+        s += "." + randomDigits(numDigitsAfterDecimal) + std::string(choose(4), '0');
+    }
+
+    if ((s.empty()) || (s == "-"))
+    {
+        s += "0";
+    }
+
+    return BigNum(s);
+}
+
+BigNum DifferentialTester::randomInteger(size_t maxDigits)
+{
+    return randomOperand(maxDigits, 0);
+}
+
+std::string DifferentialTester::checkAgainstNative()
+{
+    auto randomReference = [this]()
+    {
+        std::string digits = randomDigits(choose(MaxReferenceDigits + 1));
+
+        ReferenceInteger mantissa = 0;
+        for (char digit : digits)
+        {
+            mantissa = (mantissa * 10) + (digit - '0');
+        }
+
+        if (choose(2))
+        {
+            mantissa = -mantissa;
+        }
+
+        return ReferenceOperand{ mantissa, choose(MaxReferenceScale + 1) };
+    };
+
+    // Built from the mantissa or parsed from a possibly zero padded string
+    auto toBigNum = [this](const ReferenceOperand& n)
+    {
+        if (choose(2))
+        {
+            return BigNum(n.mantissa).dividePower10(n.scale);
+        }
+
+        std::string s = referenceToString(n);
+        bool negative = (s[0] == '-');
+
+        s = std::string(choose(3), '0') + s.substr(negative ? 1 : 0);
+        s += (s.find('.') == std::string::npos) ? "." : "";
+        s += std::string(choose(3), '0');
+
+        return BigNum((negative ? "-" : "") + s);
+    };
+
+    ReferenceOperand a = randomReference();
+    ReferenceOperand b = randomReference();
+
+    BigNum bigA = toBigNum(a);
+    BigNum bigB = toBigNum(b);
+
+    size_t scale = std::max(a.scale, b.scale);
+    ReferenceInteger alignedA = a.mantissa * referencePowerOf10(scale - a.scale);
+    ReferenceInteger alignedB = b.mantissa * referencePowerOf10(scale - b.scale);
+
+    std::string failure;
+    auto expect = [&failure](bool passed, const char* operation)
+    {
+        if (!passed && failure.empty())
+        {
+            failure = operation;
+        }
+    };
+
+    expect(bigA.display() == referenceToString(a), "a.display()");
+    expect((bigA + bigB).display() == referenceToString({ alignedA + alignedB, scale }), "a + b");
+    expect((bigA - bigB).display() == referenceToString({ alignedA - alignedB, scale }), "a - b");
+    expect((bigA * bigB).display() == referenceToString({ a.mantissa * b.mantissa, a.scale + b.scale }), "a * b");
+
+    expect((bigA < bigB) == (alignedA < alignedB), "a < b");
+    expect((bigA <= bigB) == (alignedA <= alignedB), "a <= b");
+    expect((bigA == bigB) == (alignedA == alignedB), "a == b");
+    expect((bigA >= bigB) == (alignedA >= alignedB), "a >= b");
+    expect((bigA > bigB) == (alignedA > alignedB), "a > b");
+    expect((bigA != bigB) || (bigA.hash() == bigB.hash()), "a.hash() == b.hash()");
+
+    expect(bigA.toDouble() == std::strtod(referenceToString(a).c_str(), nullptr), "a.toDouble()");
+
+    if (b.mantissa != 0)
+    {
+        expect(((bigA * bigB) / bigB) == bigA, "(a * b) / b");
+    }
+
+    // Integer operations on the mantissas themselves
+    BigNum intA(a.mantissa);
+    BigNum intB(b.mantissa);
+
+    if (b.mantissa != 0)
+    {
+        std::pair<BigNum, BigNum> quotientAndRemainder = BigNum::divMod(intA, intB);
+
+        expect(quotientAndRemainder.first.display() == referenceToString(a.mantissa / b.mantissa), "divMod(a, b).first");
+        expect(quotientAndRemainder.second.display() == referenceToString(a.mantissa % b.mantissa), "divMod(a, b).second");
+    }
+
+    expect((intA & intB).display() == referenceToString(a.mantissa & b.mantissa), "a & b");
+    expect((intA | intB).display() == referenceToString(a.mantissa | b.mantissa), "a | b");
+    expect((intA ^ intB).display() == referenceToString(a.mantissa ^ b.mantissa), "a ^ b");
+    expect((~intA).display() == referenceToString(~a.mantissa), "~a");
+
+    size_t shift = choose(MaxReferenceShift + 1);
+    ReferenceInteger powerOf2 = ReferenceInteger(1) << shift;
+
+    expect((intA << shift).display() == referenceToString(a.mantissa * powerOf2), "a << k");
+    expect((intA >> shift).display() == referenceToString(referenceFloorDivide(a.mantissa, powerOf2)), "a >> k");
+    expect(intA.popcount() == referencePopcount(a.mantissa), "a.popcount()");
+
+    expect(intA.fitsIn<long long>() && (intA.to<long long>() == static_cast<long long>(a.mantissa)), "a.to<long long>()");
+    expect(intA.fitsIn<int>() == ((a.mantissa >= std::numeric_limits<int>::min()) && (a.mantissa <= std::numeric_limits<int>::max())), "a.fitsIn<int>()");
+    expect(BigNum::fromBytes(intA.toBytes()) == intA, "BigNum::fromBytes(a.toBytes())");
+
+    if (!failure.empty())
+    {
+        failure += " failed for a = " + referenceToString(a) + ", b = " + referenceToString(b);
+    }
+
+    return failure;
+}
+
+std::string DifferentialTester::checkIdentities()
+{
+    // Mostly small operands, with the occasional one that spans several kernel blocks
+    size_t maxDigits = (choose(8) == 0) ? 600 : ((choose(2) == 0) ? 60 : 12);
+
+    BigNum a = randomOperand(maxDigits, maxDigits / 2);
+    BigNum b = randomOperand(maxDigits, maxDigits / 2);
+    BigNum c = randomOperand(maxDigits / 2, maxDigits / 4);
+
+    BigNum m = randomInteger(maxDigits);
+    BigNum n = randomInteger((maxDigits / 2) + 1);
+
+    std::string failure;
+    auto expect = [&failure](bool passed, const char* operation)
+    {
+        if (!passed && failure.empty())
+        {
+            failure = operation;
+        }
+    };
+
+    expect(((a + b) - b) == a, "(a + b) - b");
+    expect((a + b) == (b + a), "a + b == b + a");
+    expect((a - a).display() == "0", "a - a");
+    expect((-(a - a)).display() == "0", "-(a - a)");
+    expect((a == BigNum::Zero) == (a.display() == "0"), "a.display() of zero");
+    expect((a * b) == (b * a), "a * b == b * a");
+    expect(((a + b) * c) == ((a * c) + (b * c)), "(a + b) * c");
+
+    BigNum parsed(a.display());
+    expect((parsed == a) && (parsed.hash() == a.hash()), "BigNum(a.display())");
+
+    expect((a < b) == ((b - a) > BigNum::Zero), "a < b");
+    expect((a == b) == ((a - b) == BigNum::Zero), "a == b");
+
+    if (b != BigNum::Zero)
+    {
+        // Truncation leaves a remainder smaller than one unit in the last place, with the sign of a
+        size_t maxDigitsAfterDecimal = choose(40);
+        BigNum remainder = a - (BigNum::divide(a, b, maxDigitsAfterDecimal) * b);
+
+        expect(abs(remainder) < abs(b).dividePower10(maxDigitsAfterDecimal), "BigNum::divide(a, b, p)");
+        expect((remainder == BigNum::Zero) || (remainder.isNegative() == a.isNegative()), "sign of a - (BigNum::divide(a, b, p) * b)");
+    }
+
+    std::vector<BigNum> addends = { a, b, c };
+    expect(BigNum::sum(addends.begin(), addends.end()) == ((a + b) + c), "BigNum::sum({ a, b, c })");
+
+    if (n != BigNum::Zero)
+    {
+        std::pair<BigNum, BigNum> quotientAndRemainder = BigNum::divMod(m, n);
+        const BigNum& remainder = quotientAndRemainder.second;
+
+        expect(((quotientAndRemainder.first * n) + remainder) == m, "divMod(m, n)");
+        expect(abs(remainder) < abs(n), "divMod(m, n).second < n");
+        expect((remainder == BigNum::Zero) || (remainder.isNegative() == m.isNegative()), "sign of divMod(m, n).second");
+    }
+
+    size_t shift = choose(200);
+    expect(((m << shift) >> shift) == m, "(m << k) >> k");
+    expect(((m & n) + (m | n)) == (m + n), "(m & n) + (m | n)");
+    expect((m ^ m) == BigNum::Zero, "m ^ m");
+    expect(~~m == m, "~~m");
+    expect(BigNum::fromBytes(m.toBytes()) == m, "BigNum::fromBytes(m.toBytes())");
+
+    if (!failure.empty())
+    {
+        failure += " failed for a = " + a.display() + ", b = " + b.display() + ", c = " + c.display() + ", m = " + m.display() + ", n = " + n.display();
+    }
+
+    return failure;
+}
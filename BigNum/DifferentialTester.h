@@ -0,0 +1,32 @@
+#pragma once
+
+#include "BigNum.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Randomized checks of BigNum, shared by the unit tests and the fuzzer. Operands small
+// enough for native integers are checked against native arithmetic on their scaled
+// values, larger ones against identities that BigNum must satisfy exactly.
+class DifferentialTester
+{
+public:
+    // Returns a choice in [0, bound), e.g. from a seeded engine or from fuzzer input
+    using Source = std::function<std::uint32_t(std::uint32_t bound)>;
+
+    explicit DifferentialTester(Source source);
+
+    // Each returns a description of the first mismatch, or an empty string if every check passed
+    std::string checkAgainstNative();
+    std::string checkIdentities();
+
+private:
+    std::uint32_t choose(std::uint32_t bound);
+
+    std::string randomDigits(size_t numDigits);
+    BigNum randomOperand(size_t maxDigitsBeforeDecimal, size_t maxDigitsAfterDecimal);
+    BigNum randomInteger(size_t maxDigits);
+
+    Source source;
+};
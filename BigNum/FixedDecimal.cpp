@@ -0,0 +1,464 @@
+#include "FixedDecimal.h"
+
+#include <algorithm>
+#include <cassert>
+
+using Native = FixedDecimal::Native;
+using RoundingMode = FixedDecimal::RoundingMode;
+
+// Native values are kept within [-NativeMax, NativeMax], so that negating one never overflows
+static const Native NativeMax = (((Native(1) << ((8 * sizeof(Native)) - 2)) - 1) * 2) + 1;
+
+static Native absNative(Native n)
+{
+    return (n < 0) ? -n : n;
+}
+
+static bool addNative(Native a, Native b, Native& sum)
+{
+    if ((b > 0) ? (a > (NativeMax - b)) : (a < (-NativeMax - b)))
+    {
+        return false;
+    }
+
+    sum = a + b;
+    return true;
+}
+
+static bool multiplyNative(Native a, Native b, Native& product)
+{
+    if ((a != 0) && (absNative(b) > (NativeMax / absNative(a))))
+    {
+        return false;
+    }
+
+    product = a * b;
+    return true;
+}
+
+static bool nativePowerOf10(size_t power10, Native& result)
+{
+    result = 1;
+
+    for (size_t i = 0; i < power10; ++i)
+    {
+        if (!multiplyNative(result, 10, result))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool multPower10Native(Native n, size_t power10, Native& result)
+{
+    Native factor = 1;
+    return (nativePowerOf10(power10, factor) && multiplyNative(n, factor, result));
+}
+
+// Whether a quotient truncated towards zero moves one unit away from zero. comparedToHalf
+// is negative, zero or positive as the discarded remainder is below, at or above half the divisor.
+static bool roundsAwayFromZero(RoundingMode mode, bool negative, bool inexact, int comparedToHalf, bool truncatedIsOdd)
+{
+    if (!inexact)
+    {
+        return false;
+    }
+
+    switch (mode)
+    {
+    case RoundingMode::TowardZero:
+        return false;
+    case RoundingMode::AwayFromZero:
+        return true;
+    case RoundingMode::Floor:
+        return negative;
+    case RoundingMode::Ceiling:
+        return !negative;
+    case RoundingMode::HalfUp:
+        return (comparedToHalf >= 0);
+    case RoundingMode::HalfEven:
+        return ((comparedToHalf > 0) || ((comparedToHalf == 0) && truncatedIsOdd));
+    }
+
+    assert(false);
+    return false;
+}
+
+static Native divideNative(Native dividend, Native divisor, RoundingMode mode)
+{
+    Native quotient = dividend / divisor;
+    Native remainder = dividend % divisor;
+
+    // Compared as |r| against |d| - |r|, since 2 |r| may not fit
+    Native absRemainder = absNative(remainder);
+    Native rest = absNative(divisor) - absRemainder;
+    int comparedToHalf = (absRemainder < rest) ? -1 : ((absRemainder == rest) ? 0 : 1);
+
+    bool negative = ((dividend < 0) != (divisor < 0));
+
+    if (roundsAwayFromZero(mode, negative, (remainder != 0), comparedToHalf, ((quotient % 2) != 0)))
+    {
+        quotient += negative ? -1 : 1;
+    }
+
+    return quotient;
+}
+
+static BigNum divideBig(const BigNum& dividend, const BigNum& divisor, RoundingMode mode)
+{
+    std::pair<BigNum, BigNum> quotientAndRemainder = BigNum::divMod(dividend, divisor);
+    BigNum& quotient = quotientAndRemainder.first;
+
+    BigNum absRemainder = abs(quotientAndRemainder.second);
+    BigNum rest = abs(divisor) - absRemainder;
+    int comparedToHalf = (absRemainder < rest) ? -1 : ((absRemainder == rest) ? 0 : 1);
+
+    bool negative = (dividend.isNegative() != divisor.isNegative());
+    bool truncatedIsOdd = ((quotient.digitAt(quotient.getDecimalPosition()) % 2) != 0);
+
+    if (roundsAwayFromZero(mode, negative, (absRemainder != BigNum::Zero), comparedToHalf, truncatedIsOdd))
+    {
+        quotient += negative ? BigNum(-1) : BigNum(1);
+    }
+
+    return quotient;
+}
+
+FixedDecimal::FixedDecimal(const std::string& s, size_t scale, RoundingMode mode)
+    : scale(scale)
+{
+    // Parsed straight into the native integer when it fits and nothing needs rounding
+    bool negative = (!s.empty() && (s[0] == '-'));
+    bool hasDecimal = false;
+    size_t numDigits = 0;
+    size_t numDigitsAfterDecimal = 0;
+
+    Native unscaled = 0;
+    bool fitsNative = true;
+
+    for (size_t i = (negative ? 1 : 0); fitsNative && (i < s.length()); ++i)
+    {
+        if ((s[i] == '.') && !hasDecimal)
+        {
+            hasDecimal = true;
+        }
+        else if ((s[i] >= '0') && (s[i] <= '9') && (!hasDecimal || (numDigitsAfterDecimal < scale)))
+        {
+            fitsNative = multiplyNative(unscaled, 10, unscaled) && addNative(unscaled, s[i] - '0', unscaled);
+
+            ++numDigits;
+            numDigitsAfterDecimal += hasDecimal ? 1 : 0;
+        }
+        else
+        {
+            fitsNative = false;
+        }
+    }
+
+    if (fitsNative && (numDigits > 0) && multPower10Native(unscaled, scale - numDigitsAfterDecimal, unscaled))
+    {
+        native = negative ? -unscaled : unscaled;
+        return;
+    }
+
+    *this = FixedDecimal(BigNum(s), scale, mode);
+}
+
+FixedDecimal::FixedDecimal(const BigNum& n, size_t scale, RoundingMode mode)
+{
+    size_t numDigitsAfterDecimal = n.numDigitsAfterDecimal();
+
+    if (numDigitsAfterDecimal <= scale)
+    {
+        *this = fromBig(n.multPower10(scale), scale);
+    }
+    else
+    {
+        *this = fromBig(divideBig(n.multPower10(numDigitsAfterDecimal), BigNum::powerOf10(numDigitsAfterDecimal - scale), mode), scale);
+    }
+}
+
+FixedDecimal FixedDecimal::fromUnscaled(long long unscaled, size_t scale)
+{
+    if (static_cast<Native>(unscaled) < -NativeMax)
+    {
+        return fromBig(BigNum(unscaled), scale);
+    }
+
+    return fromNative(static_cast<Native>(unscaled), scale);
+}
+
+FixedDecimal FixedDecimal::fromNative(Native unscaled, size_t scale)
+{
+    FixedDecimal result;
+    result.native = unscaled;
+    result.scale = scale;
+
+    return result;
+}
+
+FixedDecimal FixedDecimal::fromBig(const BigNum& unscaled, size_t scale)
+{
+    assert(unscaled.isInteger());
+
+    if (unscaled.fitsIn<Native>())
+    {
+        Native value = unscaled.to<Native>();
+
+        if (value >= -NativeMax)
+        {
+            return fromNative(value, scale);
+        }
+    }
+
+    FixedDecimal result;
+    result.big = std::make_shared<const BigNum>(unscaled);
+    result.scale = scale;
+
+    return result;
+}
+
+size_t FixedDecimal::getScale() const
+{
+    return scale;
+}
+
+bool FixedDecimal::isNegative() const
+{
+    return isNative() ? (native < 0) : big->isNegative();
+}
+
+bool FixedDecimal::isNative() const
+{
+    return !big;
+}
+
+BigNum FixedDecimal::unscaledValue() const
+{
+    return isNative() ? BigNum(native) : *big;
+}
+
+bool FixedDecimal::rescaledNative(size_t scale, Native& unscaled) const
+{
+    assert(scale >= this->scale);
+    return (isNative() && multPower10Native(native, scale - this->scale, unscaled));
+}
+
+BigNum FixedDecimal::rescaledBig(size_t scale) const
+{
+    assert(scale >= this->scale);
+    return unscaledValue().multPower10(scale - this->scale);
+}
+
+FixedDecimal FixedDecimal::withScale(size_t scale, RoundingMode mode) const
+{
+    if (scale >= this->scale)
+    {
+        Native unscaled = 0;
+        if (rescaledNative(scale, unscaled))
+        {
+            return fromNative(unscaled, scale);
+        }
+
+        return fromBig(rescaledBig(scale), scale);
+    }
+
+    size_t power10 = this->scale - scale;
+
+    Native divisor = 1;
+    if (isNative() && nativePowerOf10(power10, divisor))
+    {
+        return fromNative(divideNative(native, divisor, mode), scale);
+    }
+
+    return fromBig(divideBig(unscaledValue(), BigNum::powerOf10(power10), mode), scale);
+}
+
+FixedDecimal FixedDecimal::multiply(const FixedDecimal& a, const FixedDecimal& b, size_t scale, RoundingMode mode)
+{
+    Native product = 0;
+    if (a.isNative() && b.isNative() && multiplyNative(a.native, b.native, product))
+    {
+        return fromNative(product, a.scale + b.scale).withScale(scale, mode);
+    }
+
+    return fromBig(a.unscaledValue() * b.unscaledValue(), a.scale + b.scale).withScale(scale, mode);
+}
+
+FixedDecimal FixedDecimal::divide(const FixedDecimal& a, const FixedDecimal& b, size_t scale, RoundingMode mode)
+{
+    if (b.isNative() && (b.native == 0))
+    {
+        assert(false);
+        return fromNative(0, scale);
+    }
+
+    // a / b == (A / 10^sa) / (B / 10^sb), so the unscaled quotient at scale s is A 10^(s + sb - sa) / B
+    size_t dividendPower10 = 0;
+    size_t divisorPower10 = 0;
+
+    if ((scale + b.scale) >= a.scale)
+    {
+        dividendPower10 = (scale + b.scale) - a.scale;
+    }
+    else
+    {
+        divisorPower10 = a.scale - (scale + b.scale);
+    }
+
+    Native dividend = 0;
+    Native divisor = 0;
+    if (a.isNative() && b.isNative() && multPower10Native(a.native, dividendPower10, dividend) && multPower10Native(b.native, divisorPower10, divisor))
+    {
+        return fromNative(divideNative(dividend, divisor, mode), scale);
+    }
+
+    return fromBig(divideBig(a.unscaledValue().multPower10(dividendPower10), b.unscaledValue().multPower10(divisorPower10), mode), scale);
+}
+
+BigNum FixedDecimal::toBigNum() const
+{
+    return unscaledValue().dividePower10(scale);
+}
+
+std::string FixedDecimal::display() const
+{
+    std::string digits;
+
+    if (isNative())
+    {
+        Native magnitude = absNative(native);
+        do
+        {
+            digits.push_back(static_cast<char>('0' + static_cast<int>(magnitude % 10)));
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        std::reverse(digits.begin(), digits.end());
+    }
+    else
+    {
+        digits = abs(*big).display();
+    }
+
+    if (digits.length() <= scale)
+    {
+        digits.insert(0, (scale + 1) - digits.length(), '0');
+    }
+
+    if (scale > 0)
+    {
+        digits.insert(digits.length() - scale, 1, '.');
+    }
+
+    return (isNegative() ? "-" : "") + digits;
+}
+
+int FixedDecimal::compare(const FixedDecimal& a, const FixedDecimal& b)
+{
+    size_t scale = std::max(a.scale, b.scale);
+
+    Native aUnscaled = 0;
+    Native bUnscaled = 0;
+    if (a.rescaledNative(scale, aUnscaled) && b.rescaledNative(scale, bUnscaled))
+    {
+        return (aUnscaled < bUnscaled) ? -1 : ((aUnscaled == bUnscaled) ? 0 : 1);
+    }
+
+    BigNum aBig = a.rescaledBig(scale);
+    BigNum bBig = b.rescaledBig(scale);
+
+    return (aBig < bBig) ? -1 : ((aBig == bBig) ? 0 : 1);
+}
+
+bool operator<(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (FixedDecimal::compare(a, b) < 0);
+}
+
+bool operator<=(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (FixedDecimal::compare(a, b) <= 0);
+}
+
+bool operator==(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (FixedDecimal::compare(a, b) == 0);
+}
+
+bool operator!=(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return !(a == b);
+}
+
+bool operator>(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (FixedDecimal::compare(a, b) > 0);
+}
+
+bool operator>=(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (FixedDecimal::compare(a, b) >= 0);
+}
+
+FixedDecimal operator+(const FixedDecimal& a, const FixedDecimal& b)
+{
+    size_t scale = std::max(a.scale, b.scale);
+
+    Native aUnscaled = 0;
+    Native bUnscaled = 0;
+    Native sum = 0;
+    if (a.rescaledNative(scale, aUnscaled) && b.rescaledNative(scale, bUnscaled) && addNative(aUnscaled, bUnscaled, sum))
+    {
+        return FixedDecimal::fromNative(sum, scale);
+    }
+
+    return FixedDecimal::fromBig(a.rescaledBig(scale) + b.rescaledBig(scale), scale);
+}
+
+void operator+=(FixedDecimal& a, const FixedDecimal& b)
+{
+    a = a + b;
+}
+
+FixedDecimal operator-(const FixedDecimal& n)
+{
+    if (n.isNative())
+    {
+        return FixedDecimal::fromNative(-n.native, n.scale);
+    }
+
+    return FixedDecimal::fromBig(-(*n.big), n.scale);
+}
+
+FixedDecimal operator-(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return (a + -(b));
+}
+
+void operator-=(FixedDecimal& a, const FixedDecimal& b)
+{
+    a = a - b;
+}
+
+FixedDecimal operator*(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return FixedDecimal::multiply(a, b, std::max(a.scale, b.scale), FixedDecimal::DefaultRoundingMode);
+}
+
+void operator*=(FixedDecimal& a, const FixedDecimal& b)
+{
+    a = a * b;
+}
+
+FixedDecimal operator/(const FixedDecimal& a, const FixedDecimal& b)
+{
+    return FixedDecimal::divide(a, b, std::max(a.scale, b.scale), FixedDecimal::DefaultRoundingMode);
+}
+
+void operator/=(FixedDecimal& a, const FixedDecimal& b)
+{
+    a = a / b;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "BigNum.h"
+
+#include <memory>
+#include <string>
+
+// A decimal with a fixed number of digits after the decimal (its scale), held as an
+// unscaled integer, e.g. 19.99 at scale 2 is 1999. Unscaled values that fit in a native
+// integer (128 bits where the compiler has them, 64 bits otherwise) are added, compared
+// and multiplied without touching the heap, larger ones fall back to BigNum.
+class FixedDecimal
+{
+friend bool operator<(const FixedDecimal& a, const FixedDecimal& b);
+friend bool operator<=(const FixedDecimal& a, const FixedDecimal& b);
+friend bool operator==(const FixedDecimal& a, const FixedDecimal& b);
+friend bool operator!=(const FixedDecimal& a, const FixedDecimal& b);
+friend bool operator>(const FixedDecimal& a, const FixedDecimal& b);
+friend bool operator>=(const FixedDecimal& a, const FixedDecimal& b);
+
+friend FixedDecimal operator+(const FixedDecimal& a, const FixedDecimal& b);
+friend void operator+=(FixedDecimal& a, const FixedDecimal& b);
+friend FixedDecimal operator-(const FixedDecimal& n);
+friend FixedDecimal operator-(const FixedDecimal& a, const FixedDecimal& b);
+friend void operator-=(FixedDecimal& a, const FixedDecimal& b);
+friend FixedDecimal operator*(const FixedDecimal& a, const FixedDecimal& b);
+friend void operator*=(FixedDecimal& a, const FixedDecimal& b);
+friend FixedDecimal operator/(const FixedDecimal& a, const FixedDecimal& b);
+friend void operator/=(FixedDecimal& a, const FixedDecimal& b);
+
+public:
+#ifdef __SIZEOF_INT128__
+    using Native = __int128;
+#else
+    using Native = long long;
+#endif
+
+    enum class RoundingMode
+    {
+        TowardZero,
+        AwayFromZero,
+        Floor,
+        Ceiling,
+        HalfUp, // ties away from zero
+        HalfEven // ties to the even neighbour
+    };
+
+    static const RoundingMode DefaultRoundingMode = RoundingMode::HalfEven;
+
+    // Digits past the scale are rounded away
+    FixedDecimal(const std::string& s, size_t scale, RoundingMode mode = DefaultRoundingMode);
+    FixedDecimal(const BigNum& n, size_t scale, RoundingMode mode = DefaultRoundingMode);
+
+    static FixedDecimal fromUnscaled(long long unscaled, size_t scale); // e.g. (1999, 2) is 19.99
+
+    size_t getScale() const;
+    bool isNegative() const;
+    bool isNative() const; // false while the unscaled value is too large for the native integer
+
+    FixedDecimal withScale(size_t scale, RoundingMode mode = DefaultRoundingMode) const;
+
+    // Sums and differences keep the larger scale of their operands exactly. Products
+    // and quotients are rounded once, operator* and operator/ round to the larger scale.
+    static FixedDecimal multiply(const FixedDecimal& a, const FixedDecimal& b, size_t scale, RoundingMode mode);
+    static FixedDecimal divide(const FixedDecimal& a, const FixedDecimal& b, size_t scale, RoundingMode mode);
+
+    BigNum toBigNum() const;
+
+    std::string display() const; // always with scale digits after the decimal, e.g. "20.00"
+
+private:
+    FixedDecimal() = default;
+
+    static FixedDecimal fromNative(Native unscaled, size_t scale);
+    static FixedDecimal fromBig(const BigNum& unscaled, size_t scale);
+
+    static int compare(const FixedDecimal& a, const FixedDecimal& b);
+
+    BigNum unscaledValue() const;
+
+    // The unscaled value at a scale no smaller than this one
+    bool rescaledNative(size_t scale, Native& unscaled) const;
+    BigNum rescaledBig(size_t scale) const;
+
+    Native native = 0;
+    std::shared_ptr<const BigNum> big; // only set when the unscaled value doesn't fit in native
+    size_t scale = 0;
+};
+
+bool operator<(const FixedDecimal& a, const FixedDecimal& b);
+bool operator<=(const FixedDecimal& a, const FixedDecimal& b);
+bool operator==(const FixedDecimal& a, const FixedDecimal& b);
+bool operator!=(const FixedDecimal& a, const FixedDecimal& b);
+bool operator>(const FixedDecimal& a, const FixedDecimal& b);
+bool operator>=(const FixedDecimal& a, const FixedDecimal& b);
+
+FixedDecimal operator+(const FixedDecimal& a, const FixedDecimal& b);
+void operator+=(FixedDecimal& a, const FixedDecimal& b);
+FixedDecimal operator-(const FixedDecimal& n);
+FixedDecimal operator-(const FixedDecimal& a, const FixedDecimal& b);
+void operator-=(FixedDecimal& a, const FixedDecimal& b);
+FixedDecimal operator*(const FixedDecimal& a, const FixedDecimal& b);
+void operator*=(FixedDecimal& a, const FixedDecimal& b);
+FixedDecimal operator/(const FixedDecimal& a, const FixedDecimal& b);
+void operator/=(FixedDecimal& a, const FixedDecimal& b);
@@ -1,7 +1,20 @@
 #include "BigNum.h"
-
+#include "BigRational.h"
+#include "BigBall.h"
+#include "BigNumAsync.h"
+#include "DifferentialTester.h"
+#include "FixedDecimal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <limits>
+#include <random>
+#include <type_traits>
+#include <unordered_set>
 
 unsigned int numPassed = 0;
 unsigned int numFailed = 0;
@@ -18,6 +31,15 @@ void printResult(const bool& actualResult)
     std::cout << std::boolalpha << actualResult;
 }
 
+template <>
+void printResult(const std::vector<unsigned char>& actualResult)
+{
+    for (unsigned char byte : actualResult)
+    {
+        std::cout << static_cast<unsigned int>(byte) << ' ';
+    }
+}
+
 template <typename resultType>
 void runUnitTest(const std::string& a, const std::string& b, const std::string& operation, const resultType& actualResult, const resultType& expectedResult)
 {
@@ -103,6 +125,11 @@ void multiplicationUnitTests()
     singleMultiplicationUnitTest("1.5", "2.25", "3.375");
     singleMultiplicationUnitTest("3", "1.23456", "3.70368");
     singleMultiplicationUnitTest("-1.23456", "3", "-3.70368");
+
+    // (10^5000 - 1)^2 == 10^10000 - 2 * 10^5000 + 1 spans several blocks of result columns
+    std::string nines(5000, '9');
+    singleMultiplicationUnitTest(nines, nines, std::string(4999, '9') + "8" + std::string(4999, '0') + "1");
+    singleMultiplicationUnitTest(nines, "0.5", "4" + std::string(4999, '9') + ".5");
 }
 
 void singleDivisionUnitTest(const std::string& a, const std::string& b, const std::string& expectedResult)
@@ -170,6 +197,621 @@ void greaterThanUnitTests()
     singleGreaterThanUnitTest("5", "4.75", true);
 }
 
+void singleDisplayUnitTest(const std::string& a, const std::string& formatName, const BigNum::DisplayFormat& format, const std::string& expectedResult)
+{
+    runUnitTest(a, formatName, " displayed ", BigNum(a).display(format), expectedResult);
+}
+
+// Rejects every write, so a stream on it goes bad straight away
+class FailingStreamBuffer : public std::streambuf
+{
+protected:
+    int_type overflow(int_type) override
+    {
+        return traits_type::eof();
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize) override
+    {
+        return 0;
+    }
+};
+
+void displayUnitTests()
+{
+    BigNum::DisplayFormat plain;
+
+    BigNum::DisplayFormat grouped;
+    grouped.groupSeparator = ',';
+
+    BigNum::DisplayFormat scientific;
+    scientific.scientific = true;
+
+    singleDisplayUnitTest("0", "plain", plain, "0");
+    singleDisplayUnitTest("-1234.5", "plain", plain, "-1234.5");
+    singleDisplayUnitTest("-0.00", "plain", plain, "0");
+
+    singleDisplayUnitTest("123", "grouped", grouped, "123");
+    singleDisplayUnitTest("1234", "grouped", grouped, "1,234");
+    singleDisplayUnitTest("-1234567.891", "grouped", grouped, "-1,234,567.891");
+
+    singleDisplayUnitTest("0", "scientific", scientific, "0e0");
+    singleDisplayUnitTest("1200", "scientific", scientific, "1.2e3");
+    singleDisplayUnitTest("-1234.5", "scientific", scientific, "-1.2345e3");
+    singleDisplayUnitTest("0.00125", "scientific", scientific, "1.25e-3");
+
+    std::string manyDigits(3 * BigNum::DisplayChunkSize + 7, '7');
+
+    std::ostringstream streamed;
+    streamed << BigNum(manyDigits);
+    runUnitTest(std::string("7...7"), std::string("ostream"), std::string(" streamed to "), streamed.str(), manyDigits);
+
+    size_t maxChunkSize = 0;
+    BigNum(manyDigits).display([&maxChunkSize](const char*, size_t numChars) { maxChunkSize = std::max(maxChunkSize, numChars); });
+    runUnitTest(std::string("7...7"), std::string("sink"), std::string(" max chunk size "), maxChunkSize, BigNum::DisplayChunkSize);
+
+    // A failing sink stops display() with its exception and isn't called again
+    size_t numSinkCalls = 0;
+    bool sinkExceptionPropagated = false;
+    try
+    {
+        BigNum(manyDigits).display([&numSinkCalls](const char*, size_t) { ++numSinkCalls; throw std::runtime_error("sink full"); });
+    }
+    catch (const std::runtime_error&)
+    {
+        sinkExceptionPropagated = true;
+    }
+    runUnitTest(std::string("7...7"), std::string("throwing sink"), std::string(" exception propagated "), sinkExceptionPropagated, true);
+    runUnitTest(std::string("7...7"), std::string("throwing sink"), std::string(" sink calls "), numSinkCalls, size_t(1));
+
+    FailingStreamBuffer failing;
+    std::ostream failingStream(&failing);
+    failingStream.exceptions(std::ios::badbit);
+
+    bool streamExceptionPropagated = false;
+    try
+    {
+        BigNum("-1234.5").display(failingStream);
+    }
+    catch (const std::ios_base::failure&)
+    {
+        streamExceptionPropagated = true;
+    }
+    runUnitTest(std::string("-1234.5"), std::string("failing ostream"), std::string(" exception propagated "), streamExceptionPropagated, true);
+}
+
+void singleBitwiseUnitTest(const std::string& a, const std::string& b, const std::string& operation, const BigNum& actualResult, const std::string& expectedResult)
+{
+    runUnitTest(a, b, operation, actualResult.display(), expectedResult);
+}
+
+void bitwiseUnitTests()
+{
+    singleBitwiseUnitTest("12", "10", " & ", BigNum("12") & BigNum("10"), "8");
+    singleBitwiseUnitTest("12", "10", " | ", BigNum("12") | BigNum("10"), "14");
+    singleBitwiseUnitTest("12", "10", " ^ ", BigNum("12") ^ BigNum("10"), "6");
+    singleBitwiseUnitTest("-12", "10", " & ", BigNum("-12") & BigNum("10"), "0");
+    singleBitwiseUnitTest("-12", "10", " | ", BigNum("-12") | BigNum("10"), "-2");
+    singleBitwiseUnitTest("-12", "-10", " ^ ", BigNum("-12") ^ BigNum("-10"), "2");
+    singleBitwiseUnitTest("", "5", "~", ~BigNum("5"), "-6");
+
+    singleBitwiseUnitTest("1", "100", " << ", BigNum("1") << 100, "1267650600228229401496703205376");
+    singleBitwiseUnitTest("1267650600228229401496703205377", "100", " >> ", BigNum("1267650600228229401496703205377") >> 100, "1");
+    singleBitwiseUnitTest("-5", "1", " >> ", BigNum("-5") >> 1, "-3");
+    singleBitwiseUnitTest("-4", "1", " >> ", BigNum("-4") >> 1, "-2");
+
+    runUnitTest(std::string("255"), std::string(""), std::string(" popcount "), BigNum("255").popcount(), size_t(8));
+    runUnitTest(std::string("-256"), std::string(""), std::string(" popcount "), BigNum("-256").popcount(), size_t(8));
+    runUnitTest(std::string("256"), std::string(""), std::string(" bitLength "), BigNum("256").bitLength(), size_t(9));
+    runUnitTest(std::string("-256"), std::string(""), std::string(" bitLength "), BigNum("-256").bitLength(), size_t(8));
+    runUnitTest(std::string("-2"), std::string("0"), std::string(" testBit "), BigNum("-2").testBit(0), false);
+    runUnitTest(std::string("-2"), std::string("1000"), std::string(" testBit "), BigNum("-2").testBit(1000), true);
+    singleBitwiseUnitTest("8", "0", " setBit ", BigNum("8").setBit(0), "9");
+
+    runUnitTest(std::string("-129"), std::string(""), std::string(" toBytes "), BigNum("-129").toBytes(), std::vector<unsigned char>{ 0xFF, 0x7F });
+    runUnitTest(std::string("128"), std::string(""), std::string(" toBytes "), BigNum("128").toBytes(), std::vector<unsigned char>{ 0x00, 0x80 });
+    singleBitwiseUnitTest("{ 0xFF, 0x7F }", "", " fromBytes ", BigNum::fromBytes({ 0xFF, 0x7F }), "-129");
+
+    // Fractional operands are truncated towards zero first
+    singleBitwiseUnitTest("1.5", "1", " & ", BigNum("1.5") & BigNum("1"), "1");
+    singleBitwiseUnitTest("-1.5", "0", " | ", BigNum("-1.5") | BigNum("0"), "-1");
+    singleBitwiseUnitTest("-0.5", "7", " & ", BigNum("-0.5") & BigNum("7"), "0");
+    singleBitwiseUnitTest("", "1.5", "~", ~BigNum("1.5"), "-2");
+    singleBitwiseUnitTest("5.9", "1", " << ", BigNum("5.9") << 1, "10");
+    singleBitwiseUnitTest("-1.5", "1", " >> ", BigNum("-1.5") >> 1, "-1");
+    runUnitTest(std::string("-0.5"), std::string(""), std::string(" popcount "), BigNum("-0.5").popcount(), size_t(0));
+    runUnitTest(std::string("-1.5"), std::string("5"), std::string(" testBit "), BigNum("-1.5").testBit(5), true);
+    runUnitTest(std::string("-1.5"), std::string(""), std::string(" toBytes "), BigNum("-1.5").toBytes(), std::vector<unsigned char>{ 0xFF });
+}
+
+void conversionUnitTests()
+{
+    runUnitTest(std::string("BigNum"), std::string("(-9223372036854775807 - 1)"), std::string(""), BigNum(std::numeric_limits<long long>::min()).display(), std::string("-9223372036854775808"));
+    runUnitTest(std::string("BigNum"), std::string("(18446744073709551615)"), std::string(""), BigNum(std::numeric_limits<unsigned long long>::max()).display(), std::string("18446744073709551615"));
+    runUnitTest(std::string("BigNum"), std::string("(-42)"), std::string(""), BigNum(-42).display(), std::string("-42"));
+    runUnitTest(std::string("BigNum"), std::string("(0.1)"), std::string(""), BigNum(0.1).display(), std::string("0.1000000000000000055511151231257827021181583404541015625"));
+    runUnitTest(std::string("BigNum"), std::string("(-1.5e20)"), std::string(""), BigNum(-1.5e20).display(), std::string("-150000000000000000000"));
+    runUnitTest(std::string("BigNum"), std::string("(0.5L)"), std::string(""), BigNum(0.5L).display(), std::string("0.5"));
+
+    runUnitTest(std::string("0.1"), std::string(""), std::string(" toDouble "), BigNum("0.1").toDouble(), 0.1);
+    runUnitTest(std::string("9007199254740993"), std::string(""), std::string(" toDouble "), BigNum("9007199254740993").toDouble(), 9007199254740992.0);
+    runUnitTest(std::string("-123.456789"), std::string(""), std::string(" toDouble "), BigNum("-123.456789").toDouble(), -123.456789);
+
+    // Past the leading digits only the rounding boundaries need the rest of the number
+    std::string justAboveMidpoint = "9007199254740993." + std::string(60, '0') + "1";
+    std::string justBelowMidpoint = "9007199254740992." + std::string(60, '9');
+    runUnitTest(justAboveMidpoint, std::string(""), std::string(" toDouble "), BigNum(justAboveMidpoint).toDouble(), 9007199254740994.0);
+    runUnitTest(justBelowMidpoint, std::string(""), std::string(" toDouble "), BigNum(justBelowMidpoint).toDouble(), 9007199254740992.0);
+    runUnitTest(std::string("0.1") + std::string(100, '0') + "1", std::string(""), std::string(" toDouble "), BigNum(std::string("0.1") + std::string(100, '0') + "1").toDouble(), 0.1);
+    runUnitTest(std::string("-1") + std::string(80000, '0'), std::string(""), std::string(" toDouble "), BigNum(std::string("-1") + std::string(80000, '0')).toDouble(), -std::numeric_limits<double>::infinity());
+    runUnitTest(std::string("1e-400"), std::string(""), std::string(" toDouble "), BigNum("0." + std::string(399, '0') + "1").toDouble(), 0.0);
+    runUnitTest(std::string("1.7976931348623157e308"), std::string(""), std::string(" toDouble "), BigNum("17976931348623157" + std::string(292, '0')).toDouble(), std::numeric_limits<double>::max());
+    runUnitTest(std::string("5e-324"), std::string(""), std::string(" toDouble "), BigNum("0." + std::string(323, '0') + "5").toDouble(), std::numeric_limits<double>::denorm_min());
+
+    runUnitTest(std::string("127"), std::string("signed char"), std::string(" fitsIn "), BigNum("127").fitsIn<signed char>(), true);
+    runUnitTest(std::string("128"), std::string("signed char"), std::string(" fitsIn "), BigNum("128").fitsIn<signed char>(), false);
+    runUnitTest(std::string("-128"), std::string("signed char"), std::string(" fitsIn "), BigNum("-128").fitsIn<signed char>(), true);
+    runUnitTest(std::string("-1"), std::string("unsigned int"), std::string(" fitsIn "), BigNum("-1").fitsIn<unsigned int>(), false);
+    runUnitTest(std::string("1.5"), std::string("int"), std::string(" fitsIn "), BigNum("1.5").fitsIn<int>(), false);
+    runUnitTest(std::string("-9223372036854775808"), std::string("long long"), std::string(" to "), BigNum("-9223372036854775808").to<long long>(), std::numeric_limits<long long>::min());
+}
+
+void singleNumberTheoryUnitTest(const std::string& a, const std::string& b, const std::string& operation, const BigNum& actualResult, const std::string& expectedResult)
+{
+    runUnitTest(a, b, operation, actualResult.display(), expectedResult);
+}
+
+void numberTheoryUnitTests()
+{
+    singleNumberTheoryUnitTest("17", "5", " / ", BigNum::divMod(BigNum("17"), BigNum("5")).first, "3");
+    singleNumberTheoryUnitTest("-17", "5", " / ", BigNum::divMod(BigNum("-17"), BigNum("5")).first, "-3");
+    singleNumberTheoryUnitTest("-17", "5", " % ", BigNum("-17") % BigNum("5"), "-2");
+    singleNumberTheoryUnitTest("17", "-5", " % ", BigNum("17") % BigNum("-5"), "2");
+    singleNumberTheoryUnitTest("100000000000000000000000000000", "7", " % ", BigNum("100000000000000000000000000000") % BigNum("7"), "5");
+
+    singleNumberTheoryUnitTest("12", "18", " gcd ", gcd(BigNum("12"), BigNum("18")), "6");
+    singleNumberTheoryUnitTest("-12", "0", " gcd ", gcd(BigNum("-12"), BigNum("0")), "12");
+    singleNumberTheoryUnitTest("4", "6", " lcm ", lcm(BigNum("4"), BigNum("6")), "12");
+
+    BigNum x(0);
+    BigNum y(0);
+    singleNumberTheoryUnitTest("240", "46", " extendedGcd ", extendedGcd(BigNum("240"), BigNum("46"), x, y), "2");
+    singleNumberTheoryUnitTest("240", "46", " extendedGcd x ", x, "-9");
+    singleNumberTheoryUnitTest("240", "46", " extendedGcd y ", y, "47");
+
+    singleNumberTheoryUnitTest("3", "11", " modInverse ", modInverse(BigNum("3"), BigNum("11")), "4");
+    singleNumberTheoryUnitTest("-3", "11", " modInverse ", modInverse(BigNum("-3"), BigNum("11")), "7");
+    singleNumberTheoryUnitTest("2^100", "1000000007", " powMod ", powMod(BigNum("2"), BigNum("100"), BigNum("1000000007")), "976371285");
+
+    runUnitTest(std::string("2^89 - 1"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(BigNum("618970019642690137449562111")), true);
+    runUnitTest(std::string("2^89 + 1"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(BigNum("618970019642690137449562113")), false);
+    runUnitTest(std::string("561"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(BigNum("561")), false);
+    runUnitTest(std::string("3215031751"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(BigNum("3215031751")), false);
+    runUnitTest(std::string("1"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(BigNum("1")), false);
+
+    // A strong pseudoprime to base 2, which only the strong Lucas test rules out with a single base
+    runUnitTest(std::string("3215031751"), std::string("1 round"), std::string(" isProbablePrime "), isProbablePrime(BigNum("3215031751"), 1), false);
+    runUnitTest(std::string("2^521 - 1"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(pow(BigNum(2), 521) - BigNum(1)), true);
+    runUnitTest(std::string("2^523 - 1"), std::string(""), std::string(" isProbablePrime "), isProbablePrime(pow(BigNum(2), 523) - BigNum(1)), false);
+
+    std::string a("19536615292288326468038496940201264538696659093845251810660445263192839715746948665311232");
+    std::string b("12435095916871292077403100294021636660046979201466280781709893066104822275981188394080969034421226906320896");
+    singleNumberTheoryUnitTest(a, b, " gcd ", gcd(BigNum(a), BigNum("-" + b)), "17352000096593946015167461762908076162667344893937528214653949432737824768");
+
+    std::string nines(60, '9');
+    singleNumberTheoryUnitTest(nines, "1" + std::string(29, '9'), " % ", BigNum(nines) % BigNum("1" + std::string(29, '9')), "24");
+}
+
+void rationalUnitTests()
+{
+    BigRational oneThird(BigNum("1"), BigNum("3"));
+    BigRational oneSixth(BigNum("1"), BigNum("6"));
+
+    runUnitTest(std::string("1/3"), std::string("1/6"), std::string(" + "), (oneThird + oneSixth).display(), std::string("1/2"));
+    runUnitTest(std::string("1/3"), std::string("1/6"), std::string(" - "), (oneThird - oneSixth).display(), std::string("1/6"));
+    runUnitTest(std::string("1/3"), std::string("1/6"), std::string(" * "), (oneThird * oneSixth).display(), std::string("1/18"));
+    runUnitTest(std::string("1/3"), std::string("1/6"), std::string(" / "), (oneThird / oneSixth).display(), std::string("2"));
+    runUnitTest(std::string("1/3"), std::string("-1/6"), std::string(" / "), (oneThird / -oneSixth).display(), std::string("-2"));
+    runUnitTest(std::string("1.5"), std::string("-0.25"), std::string(" / "), BigRational(BigNum("1.5"), BigNum("-0.25")).display(), std::string("-6"));
+
+    runUnitTest(std::string("1/3"), std::string("1/6"), std::string(" < "), (oneThird < oneSixth), false);
+    runUnitTest(std::string("2/6"), std::string("1/3"), std::string(" == "), (BigRational(BigNum("2"), BigNum("6")) == oneThird), true);
+
+    BigRational sum(BigNum("0"));
+    for (unsigned int i = 0; i < 30; ++i)
+    {
+        sum += oneThird;
+    }
+
+    runUnitTest(std::string("30 * (1/3)"), std::string(""), std::string(""), sum.display(), std::string("10"));
+    runUnitTest(std::string("2/3"), std::string("5"), std::string(" toBigNum "), BigRational(BigNum("2"), BigNum("3")).toBigNum(5).display(), std::string("0.66666"));
+
+    // Factors that cancel out are reduced away instead of piling up
+    BigRational d(BigNum("1" + std::string(99, '0') + "7"));
+    BigRational oneOverD = BigRational(BigNum(1)) / d;
+
+    BigRational cancelling(BigNum(1));
+    BigRational drifting(BigNum(1));
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+        cancelling = cancelling * oneOverD;
+        cancelling = cancelling * d;
+    }
+
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        drifting *= BigRational(BigNum(2), BigNum(3));
+        drifting *= BigRational(BigNum(3), BigNum(2));
+    }
+
+    size_t cancellingDigits = cancelling.getNumerator().numDigits() + cancelling.getDenominator().numDigits();
+    size_t driftingDigits = drifting.getNumerator().numDigits() + drifting.getDenominator().numDigits();
+
+    runUnitTest(std::string("(1/D * D)^20"), std::string(""), std::string(" digits bounded "), (cancellingDigits <= (202 + BigRational::NormalizationThreshold)), true);
+    runUnitTest(std::string("(2/3 * 3/2)^200"), std::string(""), std::string(" digits bounded "), (driftingDigits <= (4 + BigRational::NormalizationThreshold)), true);
+    runUnitTest(std::string("(1/D * D)^20"), std::string(""), std::string(" == "), cancelling.display(), std::string("1"));
+}
+
+void ballUnitTests()
+{
+    BigBall oneThird = BigBall(BigNum("1"), 10) / BigBall(BigNum("3"), 10);
+
+    runUnitTest(std::string("1"), std::string("3"), std::string(" / "), oneThird.display(), std::string("0.3333333333 +/- 0.0000000001"));
+    runUnitTest(std::string("1/3"), std::string("3"), std::string(" * "), (oneThird * BigBall(BigNum("3"))).contains(BigNum("1")), true);
+    runUnitTest(std::string("1/3"), std::string("9"), std::string(" isAccurateTo "), oneThird.isAccurateTo(9), true);
+    runUnitTest(std::string("1/3"), std::string("11"), std::string(" isAccurateTo "), oneThird.isAccurateTo(11), false);
+
+    BigBall x(BigNum("2"), BigNum("0.5"), 10);
+    BigBall y(BigNum("4"), BigNum("1"), 10);
+
+    runUnitTest(std::string("2 +/- 0.5"), std::string("4 +/- 1"), std::string(" + "), (x + y).display(), std::string("6 +/- 1.5"));
+    runUnitTest(std::string("2 +/- 0.5"), std::string("4 +/- 1"), std::string(" - "), (x - y).display(), std::string("-2 +/- 1.5"));
+    runUnitTest(std::string("2 +/- 0.5"), std::string("4 +/- 1"), std::string(" * "), (x * y).display(), std::string("8 +/- 4.5"));
+    runUnitTest(std::string("2 +/- 0.5"), std::string("4 +/- 1"), std::string(" / "), (x / y).display(), std::string("0.5 +/- 0.3333333334"));
+}
+
+// Dereferences to a BigNum value rather than to a stored BigNum, like a transforming iterator
+class SquaresIterator
+{
+public:
+    explicit SquaresIterator(int i) : i(i) {}
+
+    BigNum operator*() const { return BigNum(i * i); }
+    SquaresIterator& operator++() { ++i; return *this; }
+    bool operator!=(const SquaresIterator& other) const { return i != other.i; }
+
+private:
+    int i;
+};
+
+void sumUnitTests()
+{
+    std::vector<BigNum> addends;
+    BigNum expectedSum = BigNum::Zero;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        addends.push_back(BigNum(((i * 7919) % 100003) - 50000).dividePower10(static_cast<size_t>(i % 5)));
+        expectedSum += addends.back();
+    }
+
+    runUnitTest(std::string("5000 addends"), std::string(""), std::string(" sequential sum "), BigNum::sum(addends.begin(), addends.end()).display(), expectedSum.display());
+    runUnitTest(std::string("5000 addends"), std::string(""), std::string(" parallel sum "), BigNum::sum(addends.begin(), addends.end(), BigNum::ExecutionPolicy::Parallel).display(), expectedSum.display());
+
+    std::vector<BigNum> mixed = { BigNum("1.25"), BigNum("-3"), BigNum("0.005"), BigNum("99999999999999999999") };
+    runUnitTest(std::string("1.25 + -3 + 0.005 + 99999999999999999999"), std::string(""), std::string(" sum "), BigNum::sum(mixed.begin(), mixed.end()).display(), std::string("99999999999999999997.255"));
+
+    std::vector<BigNum> empty;
+    runUnitTest(std::string("no addends"), std::string(""), std::string(" sum "), BigNum::sum(empty.begin(), empty.end()).display(), std::string("0"));
+
+    runUnitTest(std::string("0^2 + ... + 4999^2"), std::string(""), std::string(" parallel sum of values "), BigNum::sum(SquaresIterator(0), SquaresIterator(5000), BigNum::ExecutionPolicy::Parallel).display(), std::string("41654167500"));
+}
+
+void hashUnitTests()
+{
+    BigNum onePoint50 = BigNum("1.25") + BigNum("0.25");
+
+    runUnitTest(std::string("1.25 + 0.25"), std::string("1.5"), std::string(" == "), (onePoint50 == BigNum("1.5")), true);
+    runUnitTest(std::string("1.25 + 0.25"), std::string("1.5"), std::string(" same hash "), (onePoint50.hash() == BigNum("1.5").hash()), true);
+    runUnitTest(std::string("1.5"), std::string("15"), std::string(" == "), (BigNum("1.5") == BigNum("15")), false);
+    runUnitTest(std::string("-0"), std::string("0"), std::string(" == "), (BigNum("-0") == BigNum("0")), true);
+    runUnitTest(std::string("-0"), std::string("0"), std::string(" same hash "), (BigNum("-0").hash() == BigNum("0").hash()), true);
+    runUnitTest(std::string("-7"), std::string("7"), std::string(" same hash "), (BigNum("-7").hash() == BigNum("7").hash()), false);
+
+    std::unordered_set<BigNum> distinct = { BigNum("1.5"), onePoint50, BigNum("2"), BigNum("2.000") + BigNum("0"), BigNum("-2") };
+    runUnitTest(std::string("{ 1.5, 1.50, 2, 2.000, -2 }"), std::string(""), std::string(" distinct "), distinct.size(), size_t(3));
+
+    // Containers only move elements when they grow if moving cannot throw
+    runUnitTest(std::string("BigNum"), std::string(""), std::string(" nothrow move constructible "), std::is_nothrow_move_constructible<BigNum>::value, true);
+    runUnitTest(std::string("BigNum"), std::string(""), std::string(" nothrow move assignable "), std::is_nothrow_move_assignable<BigNum>::value, true);
+}
+
+void copyOnWriteUnitTests()
+{
+    std::string manyNines(100000, '9');
+
+    BigNum original(manyNines);
+    BigNum copy = original;
+    BigNum negated = -original;
+
+    original += BigNum(1);
+
+    runUnitTest(std::string("9...9"), std::string(""), std::string(" copy unchanged after += "), (copy == BigNum(manyNines)), true);
+    runUnitTest(std::string("9...9"), std::string(""), std::string(" negated copy "), (-negated == copy), true);
+    runUnitTest(std::string("9...9 + 1"), std::string(""), std::string(" numDigits "), original.numDigits(), manyNines.size() + 1);
+
+    BigNum moved = std::move(copy);
+    runUnitTest(std::string("moved-from 9...9"), std::string(""), std::string(" numDigits "), copy.numDigits(), size_t(0));
+
+    copy = BigNum(5);
+    copy += BigNum(1);
+    runUnitTest(std::string("moved-from 9...9 = 5"), std::string("1"), std::string(" + "), copy.display(), std::string("6"));
+    runUnitTest(std::string("moved 9...9"), std::string(""), std::string(" unchanged "), (moved == BigNum(manyNines)), true);
+
+    // Negating only flips the sign, without scanning the zeroes of a power of 10
+    BigNum bigPowerOf10 = pow(BigNum(10), 2000000);
+    BigNum negatedPowerOf10 = -bigPowerOf10;
+    runUnitTest(std::string("-(10^2000000)"), std::string(""), std::string(" isNegative "), negatedPowerOf10.isNegative(), true);
+    runUnitTest(std::string("-(10^2000000)"), std::string(""), std::string(" == -(10^2000000) "), (negatedPowerOf10 == BigNum(0) - bigPowerOf10), true);
+    runUnitTest(std::string("-(-(10^2000000))"), std::string(""), std::string(" == 10^2000000 "), (-negatedPowerOf10 == bigPowerOf10), true);
+
+    BigNum paddedDifference = BigNum("1000000") - BigNum("999999.99");
+    runUnitTest(std::string("-(1000000 - 999999.99)"), std::string(""), std::string(" negated "), (-paddedDifference).display(), std::string("-0.01"));
+
+    BigNum paddedZero = BigNum("1.25") - BigNum("1.25");
+    runUnitTest(std::string("-(1.25 - 1.25)"), std::string(""), std::string(" negated "), (-paddedZero).display(), std::string("0"));
+    runUnitTest(std::string("-(1.25 - 1.25)"), std::string(""), std::string(" isNegative "), (-paddedZero).isNegative(), false);
+    runUnitTest(std::string("-(-0)"), std::string(""), std::string(" negated "), (-BigNum("-0")).display(), std::string("0"));
+    runUnitTest(std::string("-(-0)"), std::string(""), std::string(" isNegative "), (-BigNum("-0")).isNegative(), false);
+}
+
+void singleRoundingUnitTest(const std::string& a, const std::string& b, FixedDecimal::RoundingMode mode, const std::string& modeName, const std::string& expectedResult)
+{
+    runUnitTest(a, b, " * rounded " + modeName + " ", FixedDecimal::multiply(FixedDecimal(a, 2), FixedDecimal(b, 1), 1, mode).display(), expectedResult);
+}
+
+void fixedDecimalUnitTests()
+{
+    runUnitTest(std::string("19.99"), std::string("0.01"), std::string(" + "), (FixedDecimal("19.99", 2) + FixedDecimal("0.01", 2)).display(), std::string("20.00"));
+    runUnitTest(std::string("1.5"), std::string("2.25"), std::string(" - "), (FixedDecimal("1.5", 1) - FixedDecimal("2.25", 2)).display(), std::string("-0.75"));
+    runUnitTest(std::string("1999"), std::string("2"), std::string(" fromUnscaled "), FixedDecimal::fromUnscaled(1999, 2).display(), std::string("19.99"));
+    runUnitTest(std::string("-0.001"), std::string("2"), std::string(" at scale "), FixedDecimal("-0.001", 2).display(), std::string("0.00"));
+    runUnitTest(std::string("2.345"), std::string("2"), std::string(" at scale "), FixedDecimal("2.345", 2).display(), std::string("2.34"));
+    runUnitTest(std::string("1.50"), std::string("1.5"), std::string(" == "), (FixedDecimal("1.50", 2) == FixedDecimal("1.5", 1)), true);
+    runUnitTest(std::string("1.49"), std::string("1.5"), std::string(" < "), (FixedDecimal("1.49", 2) < FixedDecimal("1.5", 1)), true);
+
+    singleRoundingUnitTest("2.50", "0.5", FixedDecimal::RoundingMode::HalfEven, "half even", "1.2");
+    singleRoundingUnitTest("2.50", "0.5", FixedDecimal::RoundingMode::HalfUp, "half up", "1.3");
+    singleRoundingUnitTest("-2.50", "0.5", FixedDecimal::RoundingMode::HalfEven, "half even", "-1.2");
+    singleRoundingUnitTest("-2.50", "0.5", FixedDecimal::RoundingMode::HalfUp, "half up", "-1.3");
+    singleRoundingUnitTest("-2.51", "0.5", FixedDecimal::RoundingMode::TowardZero, "toward zero", "-1.2");
+    singleRoundingUnitTest("2.51", "0.5", FixedDecimal::RoundingMode::AwayFromZero, "away from zero", "1.3");
+    singleRoundingUnitTest("-2.51", "0.5", FixedDecimal::RoundingMode::Floor, "floor", "-1.3");
+    singleRoundingUnitTest("-2.51", "0.5", FixedDecimal::RoundingMode::Ceiling, "ceiling", "-1.2");
+
+    runUnitTest(std::string("10.00"), std::string("3"), std::string(" / "), (FixedDecimal("10.00", 2) / FixedDecimal("3", 0)).display(), std::string("3.33"));
+    runUnitTest(std::string("2"), std::string("3"), std::string(" / "), FixedDecimal::divide(FixedDecimal("2", 0), FixedDecimal("3", 0), 2, FixedDecimal::RoundingMode::HalfUp).display(), std::string("0.67"));
+
+    std::string fortyNines(40, '9');
+
+    FixedDecimal huge = FixedDecimal(fortyNines, 2) + FixedDecimal("0.01", 2);
+    runUnitTest(fortyNines, std::string("0.01"), std::string(" + "), huge.display(), fortyNines + ".01");
+    runUnitTest(fortyNines + " + 0.01", std::string(""), std::string(" is native "), huge.isNative(), false);
+    runUnitTest(fortyNines + " + 0.01", std::string(""), std::string(" squared "), ((huge * huge) == FixedDecimal(huge.toBigNum() * huge.toBigNum(), 2)), true);
+
+    FixedDecimal backToNative = huge - FixedDecimal(fortyNines, 0);
+    runUnitTest(fortyNines + " + 0.01", fortyNines, std::string(" - "), backToNative.display(), std::string("0.01"));
+    runUnitTest(fortyNines + " + 0.01 - " + fortyNines, std::string(""), std::string(" is native "), backToNative.isNative(), true);
+}
+
+template <typename Result>
+bool throwsCancelled(std::future<Result>& future)
+{
+    try
+    {
+        future.get();
+    }
+    catch (const OperationCancelled&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+void asyncUnitTests()
+{
+    runUnitTest(std::string("2"), std::string("100"), std::string(" pow "), pow(BigNum(2), 100).display(), std::string("1267650600228229401496703205376"));
+    runUnitTest(std::string("-1.5"), std::string("3"), std::string(" pow "), pow(BigNum("-1.5"), 3).display(), std::string("-3.375"));
+    runUnitTest(std::string("7"), std::string("0"), std::string(" pow "), pow(BigNum(7), 0).display(), std::string("1"));
+    runUnitTest(std::string("2"), std::string("10"), std::string(" sqrt "), sqrt(BigNum(2), 10).display(), std::string("1.4142135623"));
+    runUnitTest(std::string("144"), std::string("0"), std::string(" sqrt "), sqrt(BigNum(144), 0).display(), std::string("12"));
+    runUnitTest(std::string("0.25"), std::string("3"), std::string(" sqrt "), sqrt(BigNum("0.25"), 3).display(), std::string("0.5"));
+
+    BigNum big(std::string(6000, '7'));
+
+    runUnitTest(std::string("7...7"), std::string("12.5"), std::string(" async * "), (BigNumAsync::multiply(big, BigNum("12.5")).get() == (big * BigNum("12.5"))), true);
+    runUnitTest(std::string("2"), std::string("50"), std::string(" async sqrt "), BigNumAsync::sqrt(BigNum(2), 50).get().display(), sqrt(BigNum(2), 50).display());
+
+    BigNumAsync::Options inlineOptions;
+    inlineOptions.executor = [](std::function<void()> work) { work(); };
+
+    std::future<BigNum> quotient = BigNumAsync::divide(BigNum(1), BigNum(3), 5, inlineOptions);
+    runUnitTest(std::string("1"), std::string("3"), std::string(" async / ready from inline executor "), (quotient.wait_for(std::chrono::seconds(0)) == std::future_status::ready), true);
+    runUnitTest(std::string("1"), std::string("3"), std::string(" async / "), quotient.get().display(), std::string("0.33333"));
+
+    std::vector<double> fractions;
+    BigNumAsync::Options progressOptions;
+    progressOptions.progress = [&fractions](double fraction) { fractions.push_back(fraction); };
+
+    BigNumAsync::multiply(big, big, progressOptions).get();
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * progress reports "), (fractions.size() > 2), true);
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * progress increasing "), std::is_sorted(fractions.begin(), fractions.end()), true);
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * progress finished "), fractions.back(), 1.0);
+
+    BigNumAsync::Options cancelledOptions;
+    cancelledOptions.token.cancel();
+
+    std::future<BigNum> neverStarted = BigNumAsync::multiply(big, big, cancelledOptions);
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * cancelled before starting "), throwsCancelled(neverStarted), true);
+
+    fractions.clear();
+
+    BigNumAsync::Options cancelledPartwayOptions;
+    CancellationToken token = cancelledPartwayOptions.token;
+    cancelledPartwayOptions.progress = [&fractions, token](double fraction) mutable
+    {
+        fractions.push_back(fraction);
+        token.cancel();
+    };
+
+    std::future<BigNum> cancelledPartway = BigNumAsync::multiply(big, big, cancelledPartwayOptions);
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * cancelled partway "), throwsCancelled(cancelledPartway), true);
+    runUnitTest(std::string("7...7"), std::string("7...7"), std::string(" async * progress reports before cancelling "), fractions.size(), size_t(1));
+
+    fractions.clear();
+
+    BigNumAsync::display(big, progressOptions).get();
+    runUnitTest(std::string("7...7"), std::string(""), std::string(" async display progress reports "), (fractions.size() > 2), true);
+    runUnitTest(std::string("7...7"), std::string(""), std::string(" async display progress increasing "), std::is_sorted(fractions.begin(), fractions.end()), true);
+    runUnitTest(std::string("7...7"), std::string(""), std::string(" async display progress finished "), fractions.back(), 1.0);
+
+    fractions.clear();
+
+    BigNumAsync::Options displayCancelledPartwayOptions;
+    CancellationToken displayToken = displayCancelledPartwayOptions.token;
+    displayCancelledPartwayOptions.progress = [&fractions, displayToken](double fraction) mutable
+    {
+        fractions.push_back(fraction);
+        displayToken.cancel();
+    };
+
+    std::future<std::string> displayCancelledPartway = BigNumAsync::display(big, displayCancelledPartwayOptions);
+    runUnitTest(std::string("7...7"), std::string(""), std::string(" async display cancelled partway "), throwsCancelled(displayCancelledPartway), true);
+    runUnitTest(std::string("7...7"), std::string(""), std::string(" async display progress reports before cancelling "), fractions.size(), size_t(1));
+}
+
+void normalizationUnitTests()
+{
+    std::string million("1000000");
+    std::string justBelowMillion("999999.99");
+
+    BigNum smallDifference = BigNum(million) - BigNum(justBelowMillion);
+    runUnitTest(million, justBelowMillion, std::string(" - "), smallDifference.display(), std::string("0.01"));
+    runUnitTest(million + " - " + justBelowMillion, std::string("0.01"), std::string(" == "), (smallDifference == BigNum("0.01")), true);
+    runUnitTest(million + " - " + justBelowMillion, std::string("0.009"), std::string(" > "), (smallDifference > BigNum("0.009")), true);
+    runUnitTest(std::string("0.009"), million + " - " + justBelowMillion, std::string(" < "), (BigNum("0.009") < smallDifference), true);
+
+    std::string huge = "1" + std::string(200, '0');
+    std::string justBelowHuge(200, '9');
+
+    BigNum one = BigNum(huge) - BigNum(justBelowHuge);
+    runUnitTest(std::string("10^200"), std::string("9...9"), std::string(" - "), one.display(), std::string("1"));
+    runUnitTest(std::string("10^200 - 9...9"), std::string(""), std::string(" numDigits past threshold "), one.numDigits(), size_t(1));
+
+    BigNum tenths = BigNum("12.5") * BigNum("0.8");
+    runUnitTest(std::string("12.5"), std::string("0.8"), std::string(" * "), tenths.display(), std::string("10"));
+    runUnitTest(std::string("12.5 * 0.8"), std::string("2"), std::string(" dividePower10 "), tenths.dividePower10(2).display(), std::string("0.1"));
+
+    BigNum::DisplayFormat grouped;
+    grouped.groupSeparator = ',';
+    runUnitTest(std::string("1000000.5"), std::string("999.5"), std::string(" - grouped "), (BigNum("1000000.5") - BigNum("999.5")).display(grouped), std::string("999,001"));
+
+    runUnitTest(std::string("0.05"), std::string("2"), std::string(" multPower10 "), BigNum("0.05").multPower10(2).display(), std::string("5"));
+    runUnitTest(std::string("0.05"), std::string("1"), std::string(" multPower10 "), BigNum("0.05").multPower10(1).display(), std::string("0.5"));
+    runUnitTest(std::string("0.0001234"), std::string("7"), std::string(" multPower10 grouped "), BigNum("0.0001234").multPower10(7).display(grouped), std::string("1,234"));
+
+    // The digit accessors describe the number as displayed, whatever padding is stored
+    runUnitTest(million + " - " + justBelowMillion, std::string(""), std::string(" numDigits "), smallDifference.numDigits(), size_t(3));
+    runUnitTest(million + " - " + justBelowMillion, std::string(""), std::string(" numDigitsBeforeDecimal "), smallDifference.numDigitsBeforeDecimal(), size_t(1));
+    runUnitTest(million + " - " + justBelowMillion, std::string("1"), std::string(" digitAt "), smallDifference.digitAt(1), 0u);
+    runUnitTest(million + " - " + justBelowMillion, std::string("0"), std::string(" digitAt "), smallDifference.digitAt(0), 1u);
+
+    BigNum two = BigNum("1.25") + BigNum("0.75");
+    runUnitTest(std::string("1.25 + 0.75"), std::string(""), std::string(" numDigitsAfterDecimal "), two.numDigitsAfterDecimal(), size_t(0));
+    runUnitTest(std::string("1.25 + 0.75"), std::string(""), std::string(" getDecimalPosition "), two.getDecimalPosition(), size_t(0));
+    runUnitTest(std::string("1.25 + 0.75"), std::string("0"), std::string(" digitAt "), two.digitAt(0), 2u);
+
+    BigNum mersenne = pow(BigNum(2), 521) - BigNum(1);
+    runUnitTest(std::string("2^521 - 1"), std::string(""), std::string(" numDigits "), mersenne.numDigits(), size_t(157));
+}
+
+void differentialUnitTests()
+{
+    const unsigned int numRounds = 500;
+
+    std::mt19937 engine(20240601);
+
+    DifferentialTester tester([&engine](std::uint32_t bound)
+    {
+        return std::uniform_int_distribution<std::uint32_t>(0, bound - 1)(engine);
+    });
+
+    std::string nativeFailure;
+    std::string identityFailure;
+
+    for (unsigned int round = 0; (round < numRounds) && nativeFailure.empty(); ++round)
+    {
+        nativeFailure = tester.checkAgainstNative();
+    }
+
+    for (unsigned int round = 0; (round < numRounds) && identityFailure.empty(); ++round)
+    {
+        identityFailure = tester.checkIdentities();
+    }
+
+    runUnitTest(std::to_string(numRounds) + " random operands", std::string(""), std::string(" against native arithmetic "), nativeFailure, std::string(""));
+    runUnitTest(std::to_string(numRounds) + " random operands", std::string(""), std::string(" against identities "), identityFailure, std::string(""));
+}
+
+void powerOf10UnitTests()
+{
+    runUnitTest(std::string("10"), std::string("0"), std::string(" powerOf10 "), BigNum::powerOf10(0).display(), std::string("1"));
+    runUnitTest(std::string("10"), std::string("12"), std::string(" powerOf10 "), BigNum::powerOf10(12).display(), std::string("1000000000000"));
+    runUnitTest(std::string("10"), std::string("-3"), std::string(" reciprocalPowerOf10 "), BigNum::reciprocalPowerOf10(3).display(), std::string("0.001"));
+
+    size_t uncached = BigNum::PowerOf10CacheSize + 1;
+    runUnitTest(std::string("10"), std::to_string(uncached), std::string(" powerOf10 "), (BigNum::powerOf10(uncached) == BigNum("1" + std::string(uncached, '0'))), true);
+
+    // Filled from several threads at once, every thread has to see the same powers
+    std::vector<std::future<bool>> fills;
+    for (int t = 0; t < 4; ++t)
+    {
+        fills.push_back(std::async(std::launch::async, []()
+        {
+            bool allMatch = true;
+            for (size_t power10 = 0; power10 <= 200; ++power10)
+            {
+                allMatch = allMatch && (BigNum::powerOf10(power10) * BigNum::reciprocalPowerOf10(power10) == BigNum(1));
+            }
+            return allMatch;
+        }));
+    }
+
+    bool allThreadsMatch = true;
+    for (std::future<bool>& fill : fills)
+    {
+        allThreadsMatch = fill.get() && allThreadsMatch;
+    }
+    runUnitTest(std::string("10^k * 10^-k"), std::string("4 threads"), std::string(" == 1 "), allThreadsMatch, true);
+
+    // Division by a power of 10 splits the digits instead of dividing
+    std::pair<BigNum, BigNum> split = BigNum::divMod(BigNum("-123456789"), BigNum::powerOf10(4));
+    runUnitTest(std::string("-123456789"), std::string("10^4"), std::string(" divMod quotient "), split.first.display(), std::string("-12345"));
+    runUnitTest(std::string("-123456789"), std::string("10^4"), std::string(" divMod remainder "), split.second.display(), std::string("-6789"));
+
+    split = BigNum::divMod(BigNum("120000"), BigNum::powerOf10(4));
+    runUnitTest(std::string("120000"), std::string("10^4"), std::string(" divMod remainder "), split.second.display(), std::string("0"));
+
+    split = BigNum::divMod(BigNum("42"), BigNum::powerOf10(5));
+    runUnitTest(std::string("42"), std::string("10^5"), std::string(" divMod quotient "), split.first.display(), std::string("0"));
+    runUnitTest(std::string("42"), std::string("10^5"), std::string(" divMod remainder "), split.second.display(), std::string("42"));
+
+    runUnitTest(std::string("-2.71828"), std::string("1"), std::string(" divide to 2 digits "), BigNum::divide(BigNum("-2.71828"), BigNum(1), 2).display(), std::string("-2.71"));
+    runUnitTest(std::string("12.5"), std::string("3"), std::string(" multPower10 "), BigNum("12.5").multPower10(3).display(), std::string("12500"));
+    runUnitTest(std::string("12.5"), std::string("4"), std::string(" dividePower10 "), BigNum("12.5").dividePower10(4).display(), std::string("0.00125"));
+}
+
 int main()
 {
     additionUnitTests();
@@ -178,6 +820,20 @@ int main()
     divisionUnitTests();
     lessThanUnitTests();
     greaterThanUnitTests();
+    displayUnitTests();
+    bitwiseUnitTests();
+    conversionUnitTests();
+    numberTheoryUnitTests();
+    rationalUnitTests();
+    ballUnitTests();
+    sumUnitTests();
+    hashUnitTests();
+    copyOnWriteUnitTests();
+    normalizationUnitTests();
+    differentialUnitTests();
+    fixedDecimalUnitTests();
+    asyncUnitTests();
+    powerOf10UnitTests();
 
     std::cout << std::endl;
     std::cout << numPassed << " passed" << std::endl;